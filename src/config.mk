@@ -1,3 +1,10 @@
-
-
-SOURCES		= v1/src/lift-2D-airfoil-Bernoulli-no-uncertainties.c
+#
+#	The model core (core/src) is shared by all variants; the front-end listed last only picks the
+#	variant that runs by default (v1, v2 or v3), and --variant selects another one at run time.
+#	core/src/lift-cuda.cu is not listed: it is built with nvcc, for -DLIFT_CUDA builds only.
+#
+SOURCES		= core/src/lift-alloc.c core/src/lift-model.c core/src/lift-uncertainty-spec.c core/src/lift-density-table.c core/src/lift-cp-embedded.c core/src/lift-kernel.c \
+		  core/src/lift-sweep.c core/src/lift-batch.c core/src/lift-result-file.c core/src/lift-cp-table.c core/src/lift-csv.c \
+		  core/src/lift-airfoil-database.c core/src/lift-velocity.c core/src/lift-context.c core/src/lift-api.c core/src/lift-service.c core/src/lift-monte-carlo.c core/src/lift-summary.c core/src/lift-bench.c core/src/lift-trace.c core/src/lift-grid.c core/src/lift-variant-v1.c core/src/lift-variant-v2.c \
+		  core/src/lift-variant-v3.c core/src/lift-main.c \
+		  v1/src/lift-2D-airfoil-Bernoulli-no-uncertainties.c
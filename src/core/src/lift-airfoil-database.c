@@ -0,0 +1,290 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Airfoil database: Cp tables of many airfoils at several Reynolds numbers, listed in a manifest of
+ *	`airfoil reynolds file` lines (`#` starts a comment, relative files are relative to the manifest).
+ *
+ *	Each table is reduced, when the manifest is read, to the velocity factors of each of its angles of
+ *	attack, and the entries are kept sorted by (airfoil, Reynolds number). A lookup is then a binary search
+ *	for the airfoil and the bracketing Reynolds numbers, a binary search in each bracketing entry for the
+ *	angles of attack around the requested one, and a bilinear interpolation of the four factors. Since the
+ *	factors are averages of sqrt(|1-Cp|), interpolating them is the same as interpolating the velocity
+ *	curves station by station.
+ */
+static int
+compareEntries(const void * a, const void * b)
+{
+	const AirfoilEntry *	x = a;
+	const AirfoilEntry *	y = b;
+	int			order = strcmp(x->airfoil, y->airfoil);
+
+	if (order != 0)
+	{
+		return order;
+	}
+
+	return (x->reynolds > y->reynolds) - (x->reynolds < y->reynolds);
+}
+
+/*
+ *	Index of the first entry that does not order before (airfoil, reynolds).
+ */
+static size_t
+lowerBound(const AirfoilDatabase * database, const char * airfoil, double reynolds)
+{
+	size_t	low = 0;
+	size_t	high = database->count;
+
+	while (low < high)
+	{
+		size_t			middle = low + (high - low) / 2;
+		const AirfoilEntry *	entry = &database->entries[middle];
+		int			order = strcmp(entry->airfoil, airfoil);
+
+		if (order < 0 || (order == 0 && entry->reynolds < reynolds))
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+/*
+ *	Velocity factors of `entry` at `angle`, linearly interpolated between the tabulated angles around it,
+ *	and their slopes per degree (those of the interval above `angle` at a tabulated angle). Returns 0, or
+ *	-1 if `angle` is outside the tabulated range.
+ */
+static int
+entryFactors(const AirfoilEntry * entry, double angle, VelocityFactors * factors, VelocityFactors * slopes)
+{
+	size_t	low = 0;
+	size_t	high = entry->angleCount;
+	double	t;
+
+	if (!(angle >= entry->angles[0] && angle <= entry->angles[entry->angleCount - 1]))
+	{
+		return -1;
+	}
+	while (high - low > 1)
+	{
+		size_t	middle = low + (high - low) / 2;
+
+		if (entry->angles[middle] <= angle)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	if (low + 1 == entry->angleCount)
+	{
+		*factors = entry->factors[low];
+		if (low == 0)
+		{
+			slopes->over = slopes->under = 0.0;
+			return 0;
+		}
+		low--;
+	}
+	else
+	{
+		t		= (angle - entry->angles[low]) / (entry->angles[low + 1] - entry->angles[low]);
+		factors->over	= (1.0 - t) * entry->factors[low].over + t * entry->factors[low + 1].over;
+		factors->under	= (1.0 - t) * entry->factors[low].under + t * entry->factors[low + 1].under;
+	}
+	slopes->over	= (entry->factors[low + 1].over - entry->factors[low].over) /
+				(entry->angles[low + 1] - entry->angles[low]);
+	slopes->under	= (entry->factors[low + 1].under - entry->factors[low].under) /
+				(entry->angles[low + 1] - entry->angles[low]);
+
+	return 0;
+}
+
+/*
+ *	Load `file` (binary or CSV Cp table) and reduce it to per-angle factors.
+ */
+static int
+loadEntry(AirfoilEntry * entry, const char * file, IntegrationMode mode)
+{
+	CpTable	table;
+
+	if (cpTableLoad(file, &table) != 0)
+	{
+		return -1;
+	}
+	entry->angleCount	= table.layout.angleCount;
+	entry->angles		= liftMalloc(entry->angleCount * sizeof(double));
+	entry->factors		= liftMalloc(entry->angleCount * sizeof(VelocityFactors));
+	if (entry->angleCount == 0 || entry->angles == NULL || entry->factors == NULL)
+	{
+		cpTableFree(&table);
+		return -1;
+	}
+	for (size_t k = 0; k < entry->angleCount; k++)
+	{
+		entry->angles[k]		= table.layout.angles[k];
+		entry->factors[k].over		= velocityFactor(&table, k, CpSurfaceOver, mode);
+		entry->factors[k].under		= velocityFactor(&table, k, CpSurfaceUnder, mode);
+	}
+	cpTableFree(&table);
+
+	return 0;
+}
+
+int
+airfoilDatabaseRead(const char * manifest, IntegrationMode mode, AirfoilDatabase * database)
+{
+	FILE *		file = fopen(manifest, "r");
+	const char *	slash = strrchr(manifest, '/');
+	int		directoryLength = slash == NULL ? 0 : (int) (slash - manifest + 1);
+	size_t		capacity = 0;
+	size_t		lineNumber = 0;
+	char		line[1024];
+	int		status = 0;
+
+	memset(database, 0, sizeof(*database));
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open %s.\n", manifest);
+		return -1;
+	}
+
+	while (status == 0 && fgets(line, sizeof(line), file))
+	{
+		AirfoilEntry *	entry;
+		char		airfoil[airfoilNameLength];
+		char		path[1024];
+		char		table[1024];
+		double		reynolds;
+		int		fields;
+
+		lineNumber++;
+		line[strcspn(line, "#\r\n")] = '\0';
+		fields = sscanf(line, "%63s %lf %1023s", airfoil, &reynolds, table);
+		if (fields <= 0)
+		{
+			continue;
+		}
+		if (fields != 3)
+		{
+			fprintf(stderr, "%s:%zu: expected `airfoil reynolds file`\n", manifest, lineNumber);
+			status = -1;
+			break;
+		}
+
+		if (database->count == capacity)
+		{
+			size_t		grown = capacity == 0 ? 16 : capacity * 2;
+			AirfoilEntry *	entries = liftRealloc(database->entries, grown * sizeof(AirfoilEntry));
+
+			if (entries == NULL)
+			{
+				status = -1;
+				break;
+			}
+			database->entries	= entries;
+			capacity		= grown;
+		}
+		entry = &database->entries[database->count++];
+		memset(entry, 0, sizeof(*entry));
+		snprintf(entry->airfoil, sizeof(entry->airfoil), "%s", airfoil);
+		entry->reynolds = reynolds;
+
+		if (snprintf(path, sizeof(path), "%.*s%s", table[0] == '/' ? 0 : directoryLength, manifest, table) >=
+				(int) sizeof(path) || loadEntry(entry, path, mode) != 0)
+		{
+			fprintf(stderr, "%s:%zu: could not load the Cp table %s\n", manifest, lineNumber, path);
+			status = -1;
+		}
+	}
+	fclose(file);
+
+	if (status == 0 && database->count == 0)
+	{
+		fprintf(stderr, "%s lists no airfoils.\n", manifest);
+		status = -1;
+	}
+	if (status != 0)
+	{
+		airfoilDatabaseFree(database);
+		return -1;
+	}
+	qsort(database->entries, database->count, sizeof(AirfoilEntry), compareEntries);
+
+	return 0;
+}
+
+/*
+ *	Factors of `airfoil` at (reynolds, angle) and, if `slopes` is not NULL, their slopes per degree of
+ *	angle of attack.
+ */
+int
+airfoilDatabaseLookup(const AirfoilDatabase * database, const char * airfoil, double reynolds, double angle,
+		VelocityFactors * factors, VelocityFactors * slopes)
+{
+	size_t			first = lowerBound(database, airfoil, -HUGE_VAL);
+	size_t			end = first;
+	size_t			above;
+	VelocityFactors		low, high, lowSlopes, highSlopes, unused;
+	const AirfoilEntry *	entries = database->entries;
+	double			t;
+
+	if (slopes == NULL)
+	{
+		slopes = &unused;
+	}
+
+	while (end < database->count && strcmp(entries[end].airfoil, airfoil) == 0)
+	{
+		end++;
+	}
+	if (first == end)
+	{
+		return -1;
+	}
+
+	/*
+	 *	Reynolds numbers outside the tabulated range use the nearest entry.
+	 */
+	above = lowerBound(database, airfoil, reynolds);
+	if (above == first || above == end)
+	{
+		return entryFactors(&entries[above == end ? end - 1 : first], angle, factors, slopes);
+	}
+
+	if (entryFactors(&entries[above - 1], angle, &low, &lowSlopes) != 0 ||
+		entryFactors(&entries[above], angle, &high, &highSlopes) != 0)
+	{
+		return -1;
+	}
+	t		= (reynolds - entries[above - 1].reynolds) / (entries[above].reynolds - entries[above - 1].reynolds);
+	factors->over	= (1.0 - t) * low.over + t * high.over;
+	factors->under	= (1.0 - t) * low.under + t * high.under;
+	slopes->over	= (1.0 - t) * lowSlopes.over + t * highSlopes.over;
+	slopes->under	= (1.0 - t) * lowSlopes.under + t * highSlopes.under;
+
+	return 0;
+}
+
+void
+airfoilDatabaseFree(AirfoilDatabase * database)
+{
+	for (size_t i = 0; i < database->count; i++)
+	{
+		liftFree(database->entries[i].angles);
+		liftFree(database->entries[i].factors);
+	}
+	liftFree(database->entries);
+	memset(database, 0, sizeof(*database));
+}
@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Heap allocations made by the model go through these wrappers, which count them for --bench.
+ *
+ *	While an arena is selected on the calling thread (liftArenaSelect()), the wrappers carve their
+ *	blocks out of it instead, without touching the heap; only blocks that do not fit fall back to it.
+ *	Every block starts with an AllocationHeader saying where it came from, so liftFree() and
+ *	liftRealloc() work on any block whatever arena is selected when they run: freeing an arena block is
+ *	a no-op, its memory coming back when the arena is released past it.
+ */
+uint64_t	allocationCount;
+
+typedef enum
+{
+	AllocationHeap	= 0x48454150,
+	AllocationArena	= 0x4152454e,
+} AllocationKind;
+
+typedef struct
+{
+	size_t		size;
+	uint32_t	kind;
+	uint32_t	reserved;
+} AllocationHeader;
+
+static _Thread_local LiftArena *	selectedArena;
+
+static void *
+heapAllocate(size_t size, int zero)
+{
+	AllocationHeader *	header;
+
+	allocationCount++;
+	header = zero ? calloc(1, sizeof(*header) + size) : malloc(sizeof(*header) + size);
+	if (header == NULL)
+	{
+		return NULL;
+	}
+	header->size	= size;
+	header->kind	= AllocationHeap;
+
+	return header + 1;
+}
+
+static size_t
+alignedSize(size_t size)
+{
+	return (size + liftArenaAlignment - 1) / liftArenaAlignment * liftArenaAlignment;
+}
+
+static void *
+arenaAllocate(LiftArena * arena, size_t size)
+{
+	size_t			needed = sizeof(AllocationHeader) + alignedSize(size);
+	AllocationHeader *	header;
+
+	arena->demand += needed;
+	if (arena->capacity - arena->used < needed)
+	{
+		arena->overflowed = 1;
+		return heapAllocate(size, 0);
+	}
+	header		= (AllocationHeader *) (arena->base + arena->used);
+	header->size	= size;
+	header->kind	= AllocationArena;
+	arena->last	= arena->used;
+	arena->used	+= needed;
+
+	return header + 1;
+}
+
+void *
+liftMalloc(size_t size)
+{
+	return selectedArena != NULL ? arenaAllocate(selectedArena, size) : heapAllocate(size, 0);
+}
+
+void *
+liftCalloc(size_t count, size_t size)
+{
+	void *	pointer;
+
+	if (selectedArena == NULL)
+	{
+		return heapAllocate(count * size, 1);
+	}
+	pointer = arenaAllocate(selectedArena, count * size);
+	if (pointer != NULL)
+	{
+		memset(pointer, 0, count * size);
+	}
+
+	return pointer;
+}
+
+void *
+liftRealloc(void * pointer, size_t size)
+{
+	AllocationHeader *	header = pointer != NULL ? (AllocationHeader *) pointer - 1 : NULL;
+	LiftArena *		arena = selectedArena;
+	void *			moved;
+
+	if (header == NULL)
+	{
+		return liftMalloc(size);
+	}
+	if (header->kind == AllocationHeap)
+	{
+		allocationCount++;
+		header = realloc(header, sizeof(*header) + size);
+		if (header == NULL)
+		{
+			return NULL;
+		}
+		header->size = size;
+		return header + 1;
+	}
+
+	/*
+	 *	The most recent block of the selected arena grows in place; any other arena block is copied.
+	 */
+	if (arena != NULL && (unsigned char *) header == arena->base + arena->last &&
+		arena->capacity - arena->last >= sizeof(*header) + alignedSize(size))
+	{
+		arena->demand	+= alignedSize(size) - (arena->used - arena->last - sizeof(*header));
+		arena->used	= arena->last + sizeof(*header) + alignedSize(size);
+		header->size	= size;
+		return pointer;
+	}
+	moved = liftMalloc(size);
+	if (moved != NULL)
+	{
+		memcpy(moved, pointer, header->size < size ? header->size : size);
+	}
+
+	return moved;
+}
+
+void
+liftFree(void * pointer)
+{
+	AllocationHeader *	header;
+
+	if (pointer == NULL)
+	{
+		return;
+	}
+	header = (AllocationHeader *) pointer - 1;
+	if (header->kind == AllocationHeap)
+	{
+		free(header);
+	}
+}
+
+/*
+ *	Arenas: one block of `capacity` bytes, allocated up front, handed out front to back.
+ */
+int
+liftArenaInit(LiftArena * arena, size_t capacity)
+{
+	memset(arena, 0, sizeof(*arena));
+	allocationCount++;
+	arena->base = malloc(capacity);
+	if (arena->base == NULL)
+	{
+		return -1;
+	}
+	arena->capacity = capacity;
+
+	return 0;
+}
+
+void
+liftArenaFree(LiftArena * arena)
+{
+	free(arena->base);
+	memset(arena, 0, sizeof(*arena));
+}
+
+/*
+ *	Make `arena` (or, with NULL, the heap) source the calling thread's allocations. Returns the arena
+ *	that was selected before.
+ */
+LiftArena *
+liftArenaSelect(LiftArena * arena)
+{
+	LiftArena *	previous = selectedArena;
+
+	selectedArena = arena;
+
+	return previous;
+}
+
+LiftArenaMark
+liftArenaMark(const LiftArena * arena)
+{
+	LiftArenaMark	mark = {.used = arena->used, .demand = arena->demand};
+
+	return mark;
+}
+
+/*
+ *	Give back every arena block allocated since `mark`. Blocks that fell back to the heap since then are
+ *	left to their owners' liftFree().
+ */
+void
+liftArenaRelease(LiftArena * arena, LiftArenaMark mark)
+{
+	arena->used	= mark.used;
+	arena->demand	= mark.demand;
+	arena->last	= mark.used;
+}
@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include "lift-core.h"
+#include "lift.h"
+
+/*
+ *	Embedding API (lift.h): a LiftModel is an evaluation context (lift-context.c) and an operating point.
+ *	Single points go through computeLift() and arrays through the batch kernel in chunks of apiChunk, with
+ *	the inputs the caller does not vary held in stack arrays, so evaluation never allocates and never
+ *	writes to the handle.
+ */
+enum
+{
+	apiChunk	= 256,
+};
+
+struct LiftModel
+{
+	LiftContext	context;
+	OperatingPoint	point;
+};
+
+_Static_assert(sizeof(LiftPoint) == sizeof(OperatingPoint), "LiftPoint must match OperatingPoint");
+_Static_assert((int) LiftIntegrationSimpson == (int) IntegrationSimpson &&
+		(int) LiftIntegrationTrapezoid == (int) IntegrationTrapezoid, "LiftIntegration must match IntegrationMode");
+_Static_assert((int) LiftInterpolationSpline == (int) AngleInterpolationSpline &&
+		(int) LiftInterpolationLinear == (int) AngleInterpolationLinear,
+		"LiftInterpolation must match AngleInterpolation");
+
+static OperatingPoint
+operatingPoint(const LiftPoint * point)
+{
+	OperatingPoint	converted = {
+		.V	= point->V,
+		.h	= point->h,
+		.T	= point->T,
+		.Rh	= point->Rh,
+		.A	= point->A,
+	};
+
+	return converted;
+}
+
+LiftStatus
+liftModelCreate(const char * cpSource, LiftModel ** model)
+{
+	LiftModel *	created;
+
+	if (model == NULL)
+	{
+		return LiftErrorArgument;
+	}
+	*model	= NULL;
+	created	= liftMalloc(sizeof(*created));
+	if (created == NULL)
+	{
+		return LiftErrorMemory;
+	}
+	if (liftContextInit(&created->context, cpSource) != 0)
+	{
+		liftFree(created);
+		return cpSource == NULL ? LiftErrorMemory : LiftErrorTable;
+	}
+	created->point	= defaultOperatingPoint;
+	*model		= created;
+
+	return LiftOk;
+}
+
+LiftStatus
+liftModelConfigure(LiftModel * model, LiftIntegration integration, const char * weights,
+		LiftInterpolation interpolation)
+{
+	AngleWeights	parsed;
+
+	if (model == NULL || (int) integration < LiftIntegrationMean || integration > LiftIntegrationSimpson ||
+		(int) interpolation < LiftInterpolationNone || interpolation > LiftInterpolationSpline)
+	{
+		return LiftErrorArgument;
+	}
+	if (weights != NULL && parseAngleWeights(weights, &parsed) != 0)
+	{
+		return LiftErrorArgument;
+	}
+	parsed.interpolation = (AngleInterpolation) interpolation;
+
+	if (liftContextConfigure(&model->context, (IntegrationMode) integration, weights != NULL ? &parsed : NULL) != 0)
+	{
+		return LiftErrorWeights;
+	}
+
+	return LiftOk;
+}
+
+LiftStatus
+liftModelSetPoint(LiftModel * model, const LiftPoint * point)
+{
+	if (model == NULL || point == NULL)
+	{
+		return LiftErrorArgument;
+	}
+	model->point = operatingPoint(point);
+
+	return LiftOk;
+}
+
+LiftStatus
+liftModelEvaluate(const LiftModel * model, double * lift)
+{
+	if (model == NULL || lift == NULL)
+	{
+		return LiftErrorArgument;
+	}
+	*lift = liftContextLift(&model->context, &model->point);
+
+	return LiftOk;
+}
+
+LiftStatus
+liftModelEvaluatePoint(const LiftModel * model, const LiftPoint * point, double * lift)
+{
+	OperatingPoint	converted;
+
+	if (model == NULL || point == NULL || lift == NULL)
+	{
+		return LiftErrorArgument;
+	}
+	converted	= operatingPoint(point);
+	*lift		= liftContextLift(&model->context, &converted);
+
+	return LiftOk;
+}
+
+LiftStatus
+liftModelEvaluateArray(const LiftModel * model, size_t count, const double * V, const double * h,
+		const double * T, const double * Rh, const double * A, double * lift)
+{
+	double	held[modelInputCount][apiChunk];
+
+	if (model == NULL || (count > 0 && lift == NULL))
+	{
+		return LiftErrorArgument;
+	}
+	for (size_t i = 0; i < apiChunk; i++)
+	{
+		held[ModelInputV][i]	= model->point.V;
+		held[ModelInputH][i]	= model->point.h;
+		held[ModelInputT][i]	= model->point.T;
+		held[ModelInputRh][i]	= model->point.Rh;
+		held[ModelInputA][i]	= model->point.A;
+	}
+
+	for (size_t begin = 0; begin < count; begin += apiChunk)
+	{
+		size_t	chunk = count - begin < apiChunk ? count - begin : apiChunk;
+
+		liftKernel(chunk,
+			V != NULL ? &V[begin] : held[ModelInputV],
+			h != NULL ? &h[begin] : held[ModelInputH],
+			T != NULL ? &T[begin] : held[ModelInputT],
+			Rh != NULL ? &Rh[begin] : held[ModelInputRh],
+			A != NULL ? &A[begin] : held[ModelInputA],
+			&model->context.factors, &lift[begin]);
+	}
+
+	return LiftOk;
+}
+
+void
+liftModelDestroy(LiftModel * model)
+{
+	if (model != NULL)
+	{
+		liftContextFree(&model->context);
+		liftFree(model);
+	}
+}
+
+const char *
+liftStatusMessage(LiftStatus status)
+{
+	switch (status)
+	{
+	case LiftOk:
+		return "ok";
+	case LiftErrorArgument:
+		return "invalid argument";
+	case LiftErrorTable:
+		return "the Cp source cannot be read";
+	case LiftErrorWeights:
+		return "no angle of attack has a positive weight, or one is outside the table";
+	case LiftErrorMemory:
+		return "out of memory";
+	}
+
+	return "unknown status";
+}
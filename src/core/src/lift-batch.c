@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "lift-core.h"
+
+void
+evaluateBlockRange(void * context, int worker, size_t begin, size_t end)
+{
+	OperatingPointBlock *	block = context;
+
+	(void) worker;
+	if (block->precision == KernelPrecisionSingle)
+	{
+		OperatingPointBlockSingle *	single = &block->single;
+
+		liftKernelSingle(end - begin, &single->V[begin], &single->h[begin], &single->T[begin], &single->Rh[begin],
+				&single->A[begin], block->factors, &single->lift[begin]);
+		return;
+	}
+	if (block->density != NULL)
+	{
+		densityTableKernel(block->density, end - begin, &block->V[begin], &block->h[begin], &block->T[begin],
+				&block->Rh[begin], &block->A[begin], block->factors, &block->lift[begin]);
+		return;
+	}
+	liftKernel(end - begin, &block->V[begin], &block->h[begin], &block->T[begin], &block->Rh[begin],
+			&block->A[begin], block->factors, &block->lift[begin]);
+}
+
+static int
+flushBlock(OperatingPointBlock * block, ResultWriter * output, SweepPool * pool)
+{
+	SweepJob	job = {
+		.count		= block->count,
+		.evaluate	= evaluateBlockRange,
+		.context	= block,
+	};
+	int		status;
+
+	LIFT_TRACE_BEGIN(kernel, TraceStageKernel);
+	if (block->gpu == NULL)
+	{
+		runSweep(pool, &job);
+	}
+#if defined(LIFT_CUDA)
+	else if (gpuLiftBatch(block->gpu, block->count, block->V, block->h, block->T, block->Rh, block->A,
+			block->factors, block->lift) != 0)
+	{
+		block->count = 0;
+		return -1;
+	}
+#endif
+	LIFT_TRACE_END(kernel);
+	LIFT_TRACE_COUNT(TraceCounterPoints, block->count);
+	if (block->precision == KernelPrecisionSingle)
+	{
+		for (size_t i = 0; i < block->count; i++)
+		{
+			block->lift[i] = block->single.lift[i];
+		}
+	}
+	if (block->summary != NULL)
+	{
+		streamingSummaryAddValues(block->summary, block->lift, block->count);
+	}
+	status		= resultWriterWrite(output, block->lift, block->count);
+	block->count	= 0;
+
+	return status;
+}
+
+static void
+addPoint(OperatingPointBlock * block, const OperatingPoint * point)
+{
+	if (block->precision == KernelPrecisionSingle)
+	{
+		block->single.V[block->count]	= (float) point->V;
+		block->single.h[block->count]	= (float) point->h;
+		block->single.T[block->count]	= (float) point->T;
+		block->single.Rh[block->count]	= (float) point->Rh;
+		block->single.A[block->count]	= (float) point->A;
+	}
+	else
+	{
+		block->V[block->count]	= point->V;
+		block->h[block->count]	= point->h;
+		block->T[block->count]	= point->T;
+		block->Rh[block->count]	= point->Rh;
+		block->A[block->count]	= point->A;
+	}
+	block->count++;
+}
+
+int
+runBatch(FILE * input, ResultWriter * output, const VelocityFactors * factors, const DensityTable * density,
+		KernelPrecision precision, GpuDevice * gpu, SweepPool * pool)
+{
+	char			line[1024];
+	size_t			lineNumber = 0;
+	OperatingPoint		point;
+	OperatingPointBlock *	block;
+
+	block = liftMalloc(sizeof(*block));
+	if (block == NULL)
+	{
+		fprintf(stderr, "Could not allocate the batch buffer.\n");
+		return EXIT_FAILURE;
+	}
+	block->count		= 0;
+	block->factors		= factors;
+	block->density		= density;
+	block->precision	= precision;
+	block->gpu		= gpu;
+	block->summary		= NULL;
+
+	while (fgets(line, sizeof(line), input))
+	{
+		int	status;
+
+		lineNumber++;
+		if (lineTruncated(line, input))
+		{
+			fprintf(stderr, "line %zu: longer than %zu characters\n", lineNumber, sizeof(line) - 2);
+			liftFree(block);
+			return EXIT_FAILURE;
+		}
+		status = parseOperatingPoint(line, &point);
+		if (status == 0)
+		{
+			continue;
+		}
+		if (status < 0)
+		{
+			fprintf(stderr, "line %zu: expected `V h T Rh A`\n", lineNumber);
+			liftFree(block);
+			return EXIT_FAILURE;
+		}
+
+		addPoint(block, &point);
+		if (block->count == batchBlockSize && flushBlock(block, output, pool) != 0)
+		{
+			fprintf(stderr, "Could not write the results.\n");
+			liftFree(block);
+			return EXIT_FAILURE;
+		}
+	}
+	if (flushBlock(block, output, pool) != 0)
+	{
+		fprintf(stderr, "Could not write the results.\n");
+		liftFree(block);
+		return EXIT_FAILURE;
+	}
+	liftFree(block);
+
+	return ferror(input) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int
+runGrid(const SweepGrid * grid, uint64_t begin, uint64_t end, const VelocityFactors * angleFactors,
+		ResultWriter * output, StreamingSummary * summary, const DensityTable * density, KernelPrecision precision,
+		GpuDevice * gpu, SweepPool * pool)
+{
+	OperatingPointBlock *	block = liftMalloc(sizeof(*block));
+
+	if (block == NULL)
+	{
+		fprintf(stderr, "Could not allocate the batch buffer.\n");
+		return EXIT_FAILURE;
+	}
+	block->count		= 0;
+	block->factors		= angleFactors;
+	block->density		= density;
+	block->precision	= precision;
+	block->gpu		= gpu;
+	block->summary		= summary;
+
+	/*
+	 *	A block holds points of a single angle of attack, since they share the block's factors.
+	 */
+	for (uint64_t i = begin; i < end; i++)
+	{
+		OperatingPoint	point;
+		size_t		angle;
+
+		sweepGridPoint(grid, i, &point, &angle);
+		if ((block->count == batchBlockSize || (block->count > 0 && block->factors != &angleFactors[angle])) &&
+			flushBlock(block, output, pool) != 0)
+		{
+			fprintf(stderr, "Could not write the results.\n");
+			liftFree(block);
+			return EXIT_FAILURE;
+		}
+		block->factors = &angleFactors[angle];
+		addPoint(block, &point);
+	}
+	if (flushBlock(block, output, pool) != 0)
+	{
+		fprintf(stderr, "Could not write the results.\n");
+		liftFree(block);
+		return EXIT_FAILURE;
+	}
+	liftFree(block);
+
+	return EXIT_SUCCESS;
+}
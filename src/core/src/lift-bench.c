@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include <time.h>
+#include "lift-core.h"
+
+volatile double	benchSink;
+
+uint64_t
+monotonicNanoseconds(void)
+{
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+void
+benchBegin(BenchStage * stage, const char * name, uint64_t iterations)
+{
+	stage->name		= name;
+	stage->iterations	= iterations;
+	stage->startAllocations	= allocationCount;
+	stage->startNanoseconds	= monotonicNanoseconds();
+}
+
+void
+benchEnd(const BenchStage * stage)
+{
+	uint64_t	elapsed		= monotonicNanoseconds() - stage->startNanoseconds;
+	uint64_t	allocations	= allocationCount - stage->startAllocations;
+
+	printf("%s;%llu;%llu;%.2f;%.4f\n", stage->name, (unsigned long long) stage->iterations,
+		(unsigned long long) elapsed, (double) elapsed / stage->iterations,
+		(double) allocations / stage->iterations);
+}
+
+void
+benchHeader(const char * variant)
+{
+	printf("# %s\n", variant);
+	printf("stage;iterations;ns;ns/iteration;allocations/iteration\n");
+}
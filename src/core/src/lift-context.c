@@ -0,0 +1,158 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Evaluation context: a resident Cp table and the velocity factors of one weighting and integration
+ *	mode, with every allocation of both made in a single arena.
+ *
+ *	The table is loaded first and the arena marked after it. Configuring builds the factor samples above
+ *	the mark and releases back to it once the factors are known, so reconfiguring any number of times reuses
+ *	the same bytes; the reserve kept free above the table is enough for the largest configuration (one
+ *	sample per weighted angle of attack, then weightResolution repeated ones), so a configuration makes no
+ *	heap allocation and an evaluation none either. A table that does not fit the initial arena is loaded
+ *	again into one sized after what loading it asked for.
+ */
+enum
+{
+	contextInitialCapacity	= 1 << 20,
+	contextConfigureReserve	= (cpMaxAngles + weightResolution) * sizeof(double[2]) + 8 * liftArenaAlignment,
+};
+
+static int
+loadTable(LiftContext * context, const char * tableFile)
+{
+	LiftArena *	previous = liftArenaSelect(&context->arena);
+	int		status = cpTableLoad(tableFile, &context->table);
+
+	liftArenaSelect(previous);
+
+	return status;
+}
+
+/*
+ *	Load `tableFile`, or use the table built into the model with NULL, and configure the context for the
+ *	mean of all angles of attack. Returns 0, or -1 if the table cannot be loaded or allocated.
+ */
+int
+liftContextInit(LiftContext * context, const char * tableFile)
+{
+	size_t	capacity = tableFile == NULL ? contextConfigureReserve : contextInitialCapacity;
+
+	memset(context, 0, sizeof(*context));
+	context->embedded = tableFile == NULL;
+	for (;;)
+	{
+		if (liftArenaInit(&context->arena, capacity) != 0)
+		{
+			return -1;
+		}
+		if (context->embedded)
+		{
+			cpTableEmbedded(&context->table);
+			break;
+		}
+		if (loadTable(context, tableFile) != 0)
+		{
+			liftArenaFree(&context->arena);
+			return -1;
+		}
+		if (!context->arena.overflowed && context->arena.capacity - context->arena.used >= contextConfigureReserve)
+		{
+			break;
+		}
+
+		/*
+		 *	Blocks that fell back to the heap grew there without the arena seeing it, so the demand is
+		 *	a lower bound: at least double the capacity each time.
+		 */
+		cpTableFree(&context->table);
+		capacity = context->arena.demand + contextConfigureReserve;
+		capacity = capacity > 2 * context->arena.capacity ? capacity : 2 * context->arena.capacity;
+		liftArenaFree(&context->arena);
+	}
+	context->loaded = liftArenaMark(&context->arena);
+
+	if (liftContextConfigure(context, IntegrationMean, NULL) != 0)
+	{
+		liftContextFree(context);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ *	Factors whose lift is the expected lift over equally likely (over, under) samples. The lift is linear
+ *	in over^2 - under^2, so the root mean squares of the two factors give it exactly, as a plain number,
+ *	whether or not the build has a distribution to draw from.
+ */
+static void
+expectedFactors(const FactorSamples * samples, VelocityFactors * factors)
+{
+	double	over = 0.0;
+	double	under = 0.0;
+
+	for (size_t i = 0; i < samples->count; i++)
+	{
+		over	+= samples->samples[i][0] * samples->samples[i][0];
+		under	+= samples->samples[i][1] * samples->samples[i][1];
+	}
+	factors->over	= sqrt(over / samples->count);
+	factors->under	= sqrt(under / samples->count);
+}
+
+/*
+ *	Velocity factors of `mode` and `weights` (NULL: all angles of attack equally likely), those of the
+ *	expected lift over the weighted angles, which is the mean that v3 reports. Returns 0, or -1, leaving
+ *	the context as it was, if no angle of attack has a positive weight or one is outside the table.
+ */
+int
+liftContextConfigure(LiftContext * context, IntegrationMode mode, const AngleWeights * weights)
+{
+	LiftArena *	previous = liftArenaSelect(&context->arena);
+	VelocityFactors	factors;
+	FactorSamples	samples;
+	int		status;
+
+	liftArenaRelease(&context->arena, context->loaded);
+	status = velocityFactorSamples(&context->table, mode, weights, &samples);
+	if (status == 0)
+	{
+		expectedFactors(&samples, &factors);
+		factorSamplesFree(&samples);
+	}
+	liftArenaRelease(&context->arena, context->loaded);
+	liftArenaSelect(previous);
+	if (status != 0)
+	{
+		return -1;
+	}
+
+	context->mode		= mode;
+	context->weighted	= weights != NULL;
+	context->factors	= factors;
+	if (weights != NULL)
+	{
+		context->weights = *weights;
+	}
+
+	return 0;
+}
+
+double
+liftContextLift(const LiftContext * context, const OperatingPoint * point)
+{
+	return computeLift(point, &context->factors);
+}
+
+void
+liftContextFree(LiftContext * context)
+{
+	if (!context->embedded)
+	{
+		cpTableFree(&context->table);
+	}
+	liftArenaFree(&context->arena);
+}
@@ -0,0 +1,1032 @@
+/*
+ *	Model core shared by the v1, v2 and v3 lift models: the density chain and lift formula, the Cp tables
+ *	and velocity factors, the batch kernel, the sweep engine, the Cp table store and CSV reader and the
+ *	--bench harness. The front-ends in v1/src, v2/src and v3/src only pick the variant that runs by
+ *	default; any build of the core can run every variant with --variant (see liftMain()). Host programs
+ *	that embed the model use lift.h instead.
+ *
+ *	Build flags:
+ *	-	LIFT_NO_THREADS:	build the sweep engine without pthreads (implied when <pthread.h> is missing)
+ *	-	LIFT_NO_MMAP:		read binary Cp tables with fread() instead of mapping them (implied when
+ *					<sys/mman.h> is missing)
+ *	-	LIFT_NO_WRITEV:		write binary batch results with fwrite() instead of writev() (implied when
+ *					<sys/uio.h> is missing)
+ *	-	LIFT_KERNEL_SCALAR:	use the width-1 batch kernel whatever the target instruction set
+ *	-	LIFT_NO_MONTE_CARLO:	without <uncertain.h>, leave v2 and v3 out instead of running them on the
+ *					native Monte Carlo backend
+ *	-	LIFT_CUDA:		offload batches and Monte Carlo runs to a CUDA device with --gpu (link
+ *					lift-cuda.cu, built with nvcc, and the CUDA runtime)
+ *	-	LIFT_TRACE:		time the stages of a run and count their work, for --trace
+ *	v2 and v3 use the uncertainty runtime's <uncertain.h>. Without it, the native Monte Carlo backend
+ *	(lift-monte-carlo.c) provides the same entry points and LIFT_MONTE_CARLO is 1; with
+ *	LIFT_NO_MONTE_CARLO, LIFT_HAVE_UNCERTAIN is 0 and only v1, v3's --serve and the Cp table tools run.
+ */
+#ifndef LIFT_CORE_H
+#define LIFT_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined(__has_include)
+#if __has_include(<uncertain.h>)
+#include <uncertain.h>
+#define LIFT_HAVE_UNCERTAIN	1
+#endif
+#if !__has_include(<pthread.h>) && !defined(LIFT_NO_THREADS)
+#define LIFT_NO_THREADS
+#endif
+#if !__has_include(<sys/mman.h>) && !defined(LIFT_NO_MMAP)
+#define LIFT_NO_MMAP
+#endif
+#if !__has_include(<sys/uio.h>) && !defined(LIFT_NO_WRITEV)
+#define LIFT_NO_WRITEV
+#endif
+#endif
+
+#if !defined(LIFT_HAVE_UNCERTAIN) && !defined(LIFT_NO_MONTE_CARLO)
+#define LIFT_HAVE_UNCERTAIN	1
+#define LIFT_MONTE_CARLO	1
+#endif
+#if !defined(LIFT_HAVE_UNCERTAIN)
+#define LIFT_HAVE_UNCERTAIN	0
+#endif
+#if !defined(LIFT_MONTE_CARLO)
+#define LIFT_MONTE_CARLO	0
+#endif
+
+#if !defined(LIFT_NO_THREADS)
+#include <pthread.h>
+#endif
+
+enum {
+	cpMaxAngles		= 512,
+	weightResolution	= 1000,
+	cpTableNameLength	= 32,
+	cpTableAlignment	= 64,
+	cpTableVersion		= 1,
+	cpTableByteOrder	= 0x01020304,
+	sweepChunkSize		= 1024,
+	sweepMaxThreads		= 1024,
+	batchBlockSize		= 1 << 16,
+};
+
+/*
+ *	Heap allocations made by the model go through these wrappers, which count them for --bench, and are
+ *	released with liftFree(), never free() (lift-alloc.c). While an arena is selected, they come from
+ *	the arena instead.
+ */
+extern uint64_t	allocationCount;
+
+void *	liftMalloc(size_t size);
+void *	liftCalloc(size_t count, size_t size);
+void *	liftRealloc(void * pointer, size_t size);
+void	liftFree(void * pointer);
+
+enum
+{
+	liftArenaAlignment	= 16,
+};
+
+typedef struct
+{
+	unsigned char *	base;
+	size_t		capacity;
+	size_t		used;
+	size_t		last;		/* offset of the most recent block, which can grow in place */
+	size_t		demand;		/* bytes asked of the arena, including those it could not hold */
+	int		overflowed;	/* some block fell back to the heap */
+} LiftArena;
+
+typedef struct
+{
+	size_t	used;
+	size_t	demand;
+} LiftArenaMark;
+
+int		liftArenaInit(LiftArena * arena, size_t capacity);
+void		liftArenaFree(LiftArena * arena);
+LiftArena *	liftArenaSelect(LiftArena * arena);
+LiftArenaMark	liftArenaMark(const LiftArena * arena);
+void		liftArenaRelease(LiftArena * arena, LiftArenaMark mark);
+
+/*
+ *	Operating point and lift (lift-model.c). The same functions evaluate point-valued inputs (v1) and
+ *	inputs carrying distributions (v2, v3), since the uncertainty runtime propagates through plain double
+ *	arithmetic.
+ */
+typedef struct
+{
+	double	V;
+	double	h;
+	double	T;
+	double	Rh;
+	double	A;
+} OperatingPoint;
+
+/*
+ *	The inputs of an operating point, for code that handles them one at a time.
+ */
+typedef enum
+{
+	ModelInputV,
+	ModelInputH,
+	ModelInputT,
+	ModelInputRh,
+	ModelInputA,
+	modelInputCount,
+} ModelInput;
+
+typedef struct
+{
+	double	under;	/* average of sqrt(|1-Cp|) under the airfoil */
+	double	over;	/* average of sqrt(|1-Cp|) over the airfoil */
+} VelocityFactors;
+
+extern const OperatingPoint	defaultOperatingPoint;
+
+double	airDensity(double h, double T, double Rh);
+void	loadInputs(const OperatingPoint * point, const VelocityFactors * factors, double *  A, double *  v1, double * v2, double * r);
+double	computeLift(const OperatingPoint * point, const VelocityFactors * factors);
+int	parseOperatingPoint(const char * line, OperatingPoint * point);
+int	lineTruncated(const char * line, FILE * file);
+
+/*
+ *	Lift and its partial derivatives, computed analytically in the same pass as the lift. `angle` is the
+ *	derivative with respect to the angle of attack (per degree), through the slopes of the velocity
+ *	factors; it is 0 when the slopes are not known.
+ */
+typedef struct
+{
+	double	lift;
+	double	V;
+	double	A;
+	double	h;
+	double	T;
+	double	Rh;
+	double	angle;
+} LiftGradient;
+
+void	computeLiftGradient(const OperatingPoint * point, const VelocityFactors * factors,
+		const VelocityFactors * factorSlopes, LiftGradient * gradient);
+
+/*
+ *	Density of one atmosphere, computed once and reused for any number of (V, A) evaluations. When h, T
+ *	or Rh carry distributions, so does `r`, and the distributional arithmetic of the density chain is
+ *	done once per atmosphere instead of once per evaluation.
+ */
+typedef struct
+{
+	double	r;
+} AtmosphereContext;
+
+void	atmosphereContextInit(AtmosphereContext * atmosphere, double h, double T, double Rh);
+double	atmosphereLift(const AtmosphereContext * atmosphere, const VelocityFactors * factors, double V, double A);
+void	atmosphereLiftBatch(const AtmosphereContext * atmosphere, const VelocityFactors * factors, size_t count,
+		const double * V, const double * A, double * lift);
+
+/*
+ *	Model object for optimisation loops that change one input at a time: it caches the intermediate
+ *	quantities of the density chain and of the velocities, marks those that depend on an input dirty when
+ *	the input is set, and recomputes only the dirty ones when the lift is asked for:
+ *		h	-> Pair -> Pd -> r -> lift
+ *		T	-> Pair, Psat -> Pv -> Pd, r -> lift
+ *		Rh	-> Pv -> Pd -> r -> lift
+ *		V	-> v1, v2 -> lift
+ *		factors	-> v1, v2 -> lift
+ *		A	-> lift
+ *	The results are bit for bit those of computeLift() (lift-model.c).
+ */
+typedef enum
+{
+	IncrementalPair		= 1 << 0,
+	IncrementalPsat		= 1 << 1,
+	IncrementalPv		= 1 << 2,
+	IncrementalPd		= 1 << 3,
+	IncrementalDensity	= 1 << 4,
+	IncrementalVelocities	= 1 << 5,
+	IncrementalLift		= 1 << 6,
+	IncrementalAll		= (1 << 7) - 1,
+} IncrementalQuantity;
+
+typedef struct
+{
+	OperatingPoint	point;
+	VelocityFactors	factors;
+	unsigned	dirty;		/* IncrementalQuantity bits */
+	double		Pair;
+	double		Psat;
+	double		Pv;
+	double		Pd;
+	double		r;
+	double		v1;
+	double		v2;
+	double		lift;
+} IncrementalModel;
+
+void	incrementalModelInit(IncrementalModel * model, const OperatingPoint * point, const VelocityFactors * factors);
+void	incrementalModelSet(IncrementalModel * model, ModelInput input, double value);
+void	incrementalModelSetFactors(IncrementalModel * model, const VelocityFactors * factors);
+double	incrementalModelLift(IncrementalModel * model);
+
+/*
+ *	Per-input distributions read from an uncertainty specification file, parsed once and built once per
+ *	scenario, so that any number of evaluations reuse them (lift-uncertainty-spec.c).
+ */
+typedef enum
+{
+	InputFamilyPoint,
+	InputFamilyUniform,
+	InputFamilyGauss,
+	InputFamilySamples,
+} InputFamily;
+
+typedef struct
+{
+	InputFamily	family;
+	double		parameters[2];	/* value, low and high, or mean and variance */
+	double *	samples;
+	size_t		sampleCount;
+} InputDistribution;
+
+typedef struct
+{
+	char			name[64];
+	InputDistribution	inputs[modelInputCount];
+	OperatingPoint		point;		/* built by uncertaintySpecificationBuild() */
+	AtmosphereContext	atmosphere;
+} UncertaintyScenario;
+
+typedef struct
+{
+	size_t			count;
+	UncertaintyScenario *	scenarios;
+} UncertaintySpecification;
+
+int				uncertaintySpecificationRead(const char * filename, UncertaintySpecification * specification);
+int				uncertaintySpecificationBuild(UncertaintySpecification * specification);
+const UncertaintyScenario *	uncertaintySpecificationFind(const UncertaintySpecification * specification, const char * name);
+int				uncertaintyScenarioSample(const UncertaintyScenario * scenario, OperatingPoint * point);
+void				uncertaintySpecificationFree(UncertaintySpecification * specification);
+
+/*
+ *	Batch kernel over structure-of-arrays operating points (lift-kernel.c).
+ */
+void	liftKernel(size_t count, const double * V, const double * h, const double * T, const double * Rh,
+		const double * A, const VelocityFactors * factors, double * lift);
+
+/*
+ *	The same kernel in single precision. Over the troposphere (V 10-343 m/s, h 0-11019 m, T -50-50 °C,
+ *	any Rh and A), its lift is within a relative error of liftKernelSingleMaxError of liftKernel()'s.
+ */
+typedef enum
+{
+	KernelPrecisionDouble,
+	KernelPrecisionSingle,
+} KernelPrecision;
+
+static const double	liftKernelSingleMaxError = 1E-6;
+
+void	liftKernelSingle(size_t count, const float * V, const float * h, const float * T, const float * Rh,
+		const float * A, const VelocityFactors * factors, float * lift);
+
+/*
+ *	Optional density lookup table for sweeps over the troposphere grid, with bilinear interpolation over
+ *	(h, T) and the exact linear dependence on Rh (lift-density-table.c). `maxError` is the largest
+ *	relative error against airDensity() measured when the table is built.
+ */
+typedef struct
+{
+	size_t		hCount;
+	size_t		TCount;
+	double		hMin;
+	double		hMax;
+	double		TMin;
+	double		TMax;
+	double		hScale;		/* nodes per metre */
+	double		TScale;		/* nodes per °C */
+	double *	dry;		/* [TCount][hCount]: density of dry air */
+	double *	vapour;		/* [TCount]: density change from Rh = 0 to Rh = 1 */
+	double		maxError;
+} DensityTable;
+
+enum {
+	densityTableDefaultNodes	= 256,
+};
+
+int	densityTableInit(DensityTable * table, size_t hCount, size_t TCount);
+void	densityTableFree(DensityTable * table);
+double	densityTableLookup(const DensityTable * table, double h, double T, double Rh);
+void	densityTableKernel(const DensityTable * table, size_t count, const double * V, const double * h,
+		const double * T, const double * Rh, const double * A, const VelocityFactors * factors, double * lift);
+
+/*
+ *	Sweep engine (lift-sweep.c).
+ */
+typedef enum
+{
+	SweepScheduleStatic,
+	SweepScheduleSteal,
+} SweepSchedule;
+
+typedef struct
+{
+	size_t	count;
+	void	(*evaluate)(void * context, int worker, size_t begin, size_t end);
+	void *	context;
+} SweepJob;
+
+/*
+ *	Chunks [next, end) still owned by one thread.
+ */
+typedef struct
+{
+#if !defined(LIFT_NO_THREADS)
+	pthread_mutex_t	lock;
+#endif
+	size_t		next;
+	size_t		end;
+} SweepRange;
+
+typedef struct SweepPool	SweepPool;
+
+typedef struct
+{
+	SweepPool *	pool;
+	int		index;
+} SweepWorker;
+
+struct SweepPool
+{
+	int			threadCount;
+	SweepSchedule		schedule;
+	const SweepJob *	job;
+	SweepRange *		ranges;
+#if !defined(LIFT_NO_THREADS)
+	SweepWorker *		workers;
+	pthread_t *		threads;
+	pthread_mutex_t		lock;
+	pthread_cond_t		start;
+	pthread_cond_t		done;
+	unsigned long		generation;
+	int			running;
+	int			stop;
+#endif
+};
+
+int	sweepPoolInit(SweepPool * pool, int threadCount, SweepSchedule schedule);
+void	sweepPoolDestroy(SweepPool * pool);
+void	runSweep(SweepPool * pool, const SweepJob * job);
+
+/*
+ *	Streaming summary of sampled results in constant memory: moments, exact extremes and a mergeable
+ *	quantile sketch with 0.1% relative accuracy (lift-summary.c).
+ */
+enum
+{
+	summaryBucketCount	= 27640,	/* magnitudes from 1e-12 to 1e12 */
+};
+
+static const double	summaryRelativeAccuracy	= 1E-3;
+static const double	summaryMinMagnitude	= 1E-12;
+
+typedef struct
+{
+	uint64_t	count;
+	double		mean;
+	double		m2;
+	double		min;
+	double		max;
+	double		inverseLogGamma;
+	uint64_t	zeroCount;
+	uint64_t *	positive;
+	uint64_t *	negative;
+} StreamingSummary;
+
+int	streamingSummaryInit(StreamingSummary * summary);
+void	streamingSummaryFree(StreamingSummary * summary);
+void	streamingSummaryAdd(StreamingSummary * summary, double value);
+void	streamingSummaryAddValues(StreamingSummary * summary, const double * values, size_t count);
+void	streamingSummaryMerge(StreamingSummary * into, const StreamingSummary * from);
+double	streamingSummaryStddev(const StreamingSummary * summary);
+double	streamingSummaryQuantile(const StreamingSummary * summary, double q);
+
+/*
+ *	Summary files (.lsum), so that the shards of a sweep can be summarised where they run and merged
+ *	afterwards. streamingSummaryRead() initialises `summary`, and returns 1 if `filename` is not a
+ *	summary file, 0 on success and -1 on a malformed one.
+ */
+int	streamingSummaryWrite(const StreamingSummary * summary, const char * filename);
+int	streamingSummaryRead(const char * filename, StreamingSummary * summary);
+
+/*
+ *	Point sets of the Monte Carlo backend (lift-monte-carlo.c).
+ */
+typedef enum
+{
+	MonteCarloSamplerRandom,
+	MonteCarloSamplerHalton,
+	MonteCarloSamplerSobol,
+	MonteCarloSamplerLatin,
+} MonteCarloSampler;
+
+#if LIFT_MONTE_CARLO
+/*
+ *	Native Monte Carlo backend (lift-monte-carlo.c): the uncertainty runtime's entry points, each returning
+ *	one sample from the current sample's random stream, and a driver that evaluates the model once per
+ *	sample across the sweep threads.
+ */
+double	libUncertainDoubleUniformDist(double min, double max);
+double	libUncertainDoubleGaussDist(double mean, double variance);
+double	libUncertainDoubleDistFromSamples(double * samples, size_t sampleCount);
+void	libUncertainDoubleDistFromMultidimensionalSamples(double * destination, void * samples, size_t sampleCount,
+		size_t dimensions);
+
+enum
+{
+	monteCarloDefaultSamples	= 100000,
+};
+
+/*
+ *	A Monte Carlo model as plain data, for backends that cannot call back into the host (lift-cuda.cu):
+ *	each sample draws `draws` in order, one coordinate each as the libUncertainDouble*() calls of the host
+ *	evaluation would, into a copy of `point` and `factors`, and yields the lift (or, with `density`, the
+ *	air density) there.
+ */
+typedef enum
+{
+	MonteCarloDrawUniform,		/* parameters: low, high */
+	MonteCarloDrawGauss,		/* parameters: mean, variance */
+	MonteCarloDrawFactors,		/* one of `factorSamples`, equally likely */
+} MonteCarloDrawKind;
+
+typedef struct
+{
+	MonteCarloDrawKind	kind;
+	ModelInput		input;
+	double			parameters[2];
+} MonteCarloDraw;
+
+typedef struct
+{
+	OperatingPoint		point;
+	VelocityFactors		factors;
+	int			density;
+	size_t			drawCount;
+	MonteCarloDraw		draws[modelInputCount + 1];
+	size_t			factorSampleCount;
+	const double		(*factorSamples)[2];	/* (over, under) */
+} MonteCarloModel;
+
+typedef struct
+{
+	uint64_t		samples;
+	uint64_t		seed;
+	MonteCarloSampler	sampler;
+	int			threadCount;	/* 0: one per core */
+	const MonteCarloModel *	gpu;		/* LIFT_CUDA: run this model on the device instead */
+} MonteCarloOptions;
+
+typedef struct
+{
+	uint64_t	count;
+	double		mean;
+	double		stddev;
+	double		min;
+	double		max;
+	double		quantiles[3];	/* 5%, 50% and 95% */
+} MonteCarloSummary;
+
+/*
+ *	values[i] for the samples first .. first+count-1.
+ */
+typedef void	(*MonteCarloEvaluate)(void * context, uint64_t first, size_t count, double * values);
+
+int	monteCarloParseSampler(const char * name, MonteCarloSampler * sampler);
+void	monteCarloSelectSample(uint64_t sample);
+int	monteCarloRun(const MonteCarloOptions * options, MonteCarloEvaluate evaluate, void * context,
+		StreamingSummary * summary);
+void	monteCarloSummarize(const StreamingSummary * streaming, MonteCarloSummary * summary);
+int	monteCarloEstimate(const MonteCarloOptions * options, MonteCarloEvaluate evaluate, void * context,
+		MonteCarloSummary * summary);
+void	monteCarloPrintSummary(FILE * output, const MonteCarloSummary * summary);
+#endif
+
+/*
+ *	CUDA offload (lift-cuda.cu, with LIFT_CUDA): batches of points and Monte Carlo runs evaluated on the
+ *	device, with transfers overlapping the kernels and Monte Carlo samples summarised on the device.
+ */
+typedef struct GpuDevice	GpuDevice;
+
+#if defined(LIFT_CUDA)
+GpuDevice *	gpuOpen(void);
+void		gpuClose(GpuDevice * device);
+int		gpuLiftBatch(GpuDevice * device, size_t count, const double * V, const double * h, const double * T,
+			const double * Rh, const double * A, const VelocityFactors * factors, double * lift);
+#if LIFT_MONTE_CARLO
+int		gpuMonteCarloRun(const MonteCarloOptions * options, const MonteCarloModel * model,
+			StreamingSummary * summary);
+#endif
+#endif
+
+/*
+ *	Batch mode: operating points of one batch, stored as structure-of-arrays for liftKernel()
+ *	(lift-batch.c). In single precision, the points live in `single` and only `lift` of the double
+ *	arrays is used, for the widened results.
+ */
+typedef struct
+{
+	float	V[batchBlockSize];
+	float	h[batchBlockSize];
+	float	T[batchBlockSize];
+	float	Rh[batchBlockSize];
+	float	A[batchBlockSize];
+	float	lift[batchBlockSize];
+} OperatingPointBlockSingle;
+
+typedef struct
+{
+	size_t				count;
+	const VelocityFactors *		factors;
+	const DensityTable *		density;	/* NULL: exact density */
+	KernelPrecision			precision;
+	GpuDevice *			gpu;		/* NULL: the sweep engine */
+	StreamingSummary *		summary;	/* NULL, or the summary of every lift evaluated */
+	double				V[batchBlockSize];
+	double				h[batchBlockSize];
+	double				T[batchBlockSize];
+	double				Rh[batchBlockSize];
+	double				A[batchBlockSize];
+	double				lift[batchBlockSize];
+	OperatingPointBlockSingle	single;
+} OperatingPointBlock;
+
+/*
+ *	Output of batch results: `%f` text lines, or a binary columnar stream of (index, lift) blocks
+ *	(lift-result-file.c).
+ */
+typedef enum
+{
+	ResultFormatText,
+	ResultFormatFloat64,
+	ResultFormatFloat32,
+} ResultFormat;
+
+enum
+{
+	resultAlignment		= 64,
+	resultFileVersion	= 1,
+};
+
+typedef struct
+{
+	ResultFormat	format;
+	FILE *		output;
+	uint64_t	written;	/* points written so far: the index of the next one */
+	uint64_t *	indices;	/* binary formats: index column of a block */
+	float *		narrowed;	/* ResultFormatFloat32: lift column of a block */
+} ResultWriter;
+
+int	parseResultFormat(const char * name, ResultFormat * format);
+int	resultWriterInit(ResultWriter * writer, FILE * output, ResultFormat format);
+int	resultWriterWrite(ResultWriter * writer, const double * lift, size_t count);
+int	resultWriterFinish(ResultWriter * writer);
+
+/*
+ *	Concatenate binary result files whose index ranges follow each other, in any order, into one.
+ *	Returns 1 if the first input is not a result file, 0 on success and -1 if the inputs do not fit
+ *	together or cannot be read or written.
+ */
+int	resultFilesMerge(const char * output, const char * const * inputs, size_t count);
+
+void	evaluateBlockRange(void * context, int worker, size_t begin, size_t end);
+int	runBatch(FILE * input, ResultWriter * output, const VelocityFactors * factors, const DensityTable * density,
+		KernelPrecision precision, GpuDevice * gpu, SweepPool * pool);
+
+/*
+ *	Sweep grids (lift-grid.c): evenly spaced values of V, h, T, Rh, A and the angle of attack, numbered
+ *	with A varying fastest and the angle slowest, so that the points of one angle, which share their
+ *	velocity factors, are contiguous. A shard is a contiguous range of those numbers; shard i of n is the
+ *	same range on every node, so nodes need no coordination and their results join by index.
+ */
+typedef enum
+{
+	GridAxisV,
+	GridAxisH,
+	GridAxisT,
+	GridAxisRh,
+	GridAxisA,
+	GridAxisAngle,
+	gridAxisCount,
+} GridAxis;
+
+typedef struct
+{
+	double		low;
+	double		high;
+	uint64_t	count;		/* 0: the axis is not swept (the angle axis only) */
+} GridRange;
+
+typedef struct
+{
+	GridRange	axes[gridAxisCount];
+	uint64_t	pointCount;
+} SweepGrid;
+
+int	parseSweepGrid(const char * specification, SweepGrid * grid);
+int	parseShard(const char * specification, uint64_t * shard, uint64_t * shardCount);
+double	sweepGridValue(const GridRange * range, uint64_t index);
+void	sweepGridShard(const SweepGrid * grid, uint64_t shard, uint64_t shardCount, uint64_t * begin, uint64_t * end);
+void	sweepGridPoint(const SweepGrid * grid, uint64_t index, OperatingPoint * point, size_t * angle);
+
+/*
+ *	Evaluate points begin .. end-1 of `grid` through the batch kernel, with angleFactors[k] the velocity
+ *	factors of value k of the angle axis (angleFactors[0] when it is not swept).
+ */
+int	runGrid(const SweepGrid * grid, uint64_t begin, uint64_t end, const VelocityFactors * angleFactors,
+		ResultWriter * output, StreamingSummary * summary, const DensityTable * density, KernelPrecision precision,
+		GpuDevice * gpu, SweepPool * pool);
+
+/*
+ *	Cp table store (lift-cp-table.c).
+ */
+typedef enum
+{
+	CpSurfaceOver	= 0,
+	CpSurfaceUnder	= 1,
+} CpSurface;
+
+/*
+ *	Angles of attack of a Cp table, in ascending order, as discovered from its column names: `x` is the
+ *	station column, `Curve<angle>` the Cp curve over and `Curve<angle>l` the Cp curve under the airfoil
+ *	at <angle> degrees (e.g. Curve10, Curve-4l, Curve2.5).
+ */
+typedef struct
+{
+	size_t	angleCount;
+	double	angles[cpMaxAngles];
+} CpLayout;
+
+/*
+ *	Pressure coefficient store: `columns` named columns of `rows` stations each, in one contiguous
+ *	column-major buffer. Column 0 is the `x` station column, and the curve of the k-th angle of attack of
+ *	`layout` on surface s is column 1 + 2*k + s, so the store is indexed by (angle of attack, surface,
+ *	station) and every curve is a contiguous array (see cpTableCurve()).
+ *	The values either live in `owned` (parsed from CSV) or point straight into a mapped binary file.
+ */
+typedef struct
+{
+	CpLayout	layout;
+	size_t		rows;
+	size_t		columns;
+	char		(*names)[cpTableNameLength];
+	const double *	values;
+	double *	owned;
+	void *		mapping;
+	size_t		mappingSize;
+} CpTable;
+
+const double *	cpTableColumn(const CpTable * table, size_t column);
+const double *	cpTableCurve(const CpTable * table, size_t angle, CpSurface surface);
+size_t		cpLayoutColumnCount(const CpLayout * layout);
+int		cpLayoutFromNames(CpLayout * layout, size_t columns, char (*names)[cpTableNameLength]);
+int		cpLayoutColumn(const CpLayout * layout, const char * name);
+void		cpLayoutColumnName(const CpLayout * layout, size_t column, char name[cpTableNameLength]);
+void		cpTableFree(CpTable * table);
+int		cpTableMap(const char * filename, CpTable * table);
+int		cpTableWrite(const CpTable * table, const char * filename);
+
+/*
+ *	Cp table built into the model at build time from v3/inputs/all_angles.csv; v1 and v2 use its 10°
+ *	curves (lift-cp-embedded.c).
+ */
+void	cpTableEmbedded(CpTable * table);
+void	precomputeEmbeddedVelocityFactors(VelocityFactors * factors);
+void	embeddedVelocityFactorSlopes(VelocityFactors * slopes);
+
+/*
+ *	How the velocity factor, the average of sqrt(|1-Cp|) over a surface, is formed from the stations:
+ *	-	IntegrationMean:	arithmetic mean over the stations, ignoring their spacing
+ *	-	IntegrationTrapezoid:	chord-weighted, trapezoidal rule over `x`, divided by the covered chord
+ *	-	IntegrationSimpson:	chord-weighted, composite Simpson rule for unevenly spaced `x` (with a
+ *					trapezoid on the last interval when their number is odd)
+ *	The chord-weighted modes converge on unevenly spaced and downsampled tables, where the plain mean
+ *	over-weights densely sampled regions such as the leading edge (lift-velocity.c).
+ */
+typedef enum
+{
+	IntegrationMean,
+	IntegrationTrapezoid,
+	IntegrationSimpson,
+} IntegrationMode;
+
+/*
+ *	Running sums of sqrt(|1-Cp|) along one curve, fed one station at a time, for all integration modes.
+ */
+typedef struct
+{
+	uint64_t	count;
+	double		firstX;
+	double		x[2];		/* previous two stations, most recent first */
+	double		velocity[2];	/* sqrt(|1-Cp|) at those stations */
+	double		velocitySum;
+	double		trapezoidSum;
+	double		simpsonSum;	/* over the first 2*floor((count-1)/2) intervals */
+} VelocityIntegral;
+
+void	velocityIntegralAdd(VelocityIntegral * integral, double x, double Cp);
+double	velocityIntegralFactor(const VelocityIntegral * integral, IntegrationMode mode);
+double	velocityFactor(const CpTable * table, size_t angle, CpSurface surface, IntegrationMode mode);
+
+/*
+ *	Cp curve at an angle of attack between the tabulated ones, as a weighted sum of at most four
+ *	tabulated curves: the two around the angle (linear) or also their outer neighbours (spline, a cubic
+ *	Hermite spline with finite-difference slopes, which reduces to Catmull-Rom for evenly spaced angles).
+ *	The weights depend only on the angle, so they are planned once per angle and every station then
+ *	costs one fused multiply-add per curve.
+ */
+typedef enum
+{
+	AngleInterpolationNone,		/* tabulated angles only */
+	AngleInterpolationLinear,
+	AngleInterpolationSpline,
+} AngleInterpolation;
+
+typedef struct
+{
+	size_t	count;
+	size_t	curves[4];	/* angle indices into the layout */
+	double	weights[4];
+	double	slopes[4];	/* d weight / d angle, per degree */
+} CurvePlan;
+
+int	curvePlanInit(CurvePlan * plan, const CpLayout * layout, double angle, AngleInterpolation interpolation);
+double	plannedVelocityFactor(const CpTable * table, const CurvePlan * plan, CpSurface surface, IntegrationMode mode);
+double	plannedVelocityFactorSlope(const CpTable * table, const CurvePlan * plan, CpSurface surface,
+		IntegrationMode mode);
+
+/*
+ *	Streaming CSV reader (lift-csv.c).
+ */
+typedef struct
+{
+	int	(*header)(void * context, size_t columns, char (*names)[cpTableNameLength]);
+	int	(*row)(void * context, const double * values);
+	void *	context;
+} CsvSink;
+
+/*
+ *	Per-column statistics, accumulated one station at a time (Welford's update for the variance), together
+ *	with the running integral of sqrt(|1-Cp|) over `x`, from which the velocity factor follows.
+ */
+typedef struct
+{
+	uint64_t		count;
+	double			mean;
+	double			m2;
+	double			min;
+	double			max;
+	VelocityIntegral	integral;
+} CpColumnStatistics;
+
+typedef struct
+{
+	CpLayout		layout;
+	size_t			fileColumns;
+	size_t			xColumn;
+	int *			slot;
+	CpColumnStatistics *	columns;
+} CpStatistics;
+
+int	streamCsv(FILE * file, const CsvSink * sink);
+int	cpStatisticsReadCsv(const char * filename, CpStatistics * statistics);
+int	cpTableReadCsv(const char * filename, CpTable * table);
+int	cpTableLoad(const char * filename, CpTable * table);
+
+/*
+ *	Uncertain angle of attack: per-angle velocity factors and their joint distribution (lift-velocity.c).
+ *	Optional weights of the angles of attack are given as `angle:weight,...`; angles of the table that are
+ *	not listed get weight 0. With an interpolation, the listed angles need not be tabulated: each one
+ *	contributes the Cp curve interpolated at that angle (which needs the whole table, not the running sums
+ *	of a streamed CSV).
+ */
+typedef struct
+{
+	size_t			count;
+	double			angles[cpMaxAngles];
+	double			weights[cpMaxAngles];
+	AngleInterpolation	interpolation;
+} AngleWeights;
+
+/*
+ *	Equally likely (over, under) velocity factor samples, one or more per angle of attack, from which the
+ *	joint distribution of the factors is built.
+ */
+typedef struct
+{
+	size_t		count;
+	double		(*samples)[2];
+} FactorSamples;
+
+int	parseAngleWeights(const char * specification, AngleWeights * weights);
+int	velocityFactorSamples(const CpTable * table, IntegrationMode mode, const AngleWeights * weights,
+		FactorSamples * samples);
+int	velocityFactorSamplesFromStatistics(const CpStatistics * statistics, IntegrationMode mode,
+		const AngleWeights * weights, FactorSamples * samples);
+int	velocityFactorsFromSamples(const FactorSamples * samples, VelocityFactors * factors);
+void	factorSamplesFree(FactorSamples * samples);
+int	precomputeVelocityFactors(const CpTable * table, IntegrationMode mode, const AngleWeights * weights,
+		VelocityFactors * factors);
+int	precomputeVelocityFactorsFromStatistics(const CpStatistics * statistics, IntegrationMode mode,
+		const AngleWeights * weights, VelocityFactors * factors);
+
+/*
+ *	Velocity factors of many airfoils, keyed by (airfoil, Reynolds number, angle of attack) and
+ *	interpolated between neighbouring Reynolds numbers and angles (lift-airfoil-database.c).
+ */
+enum
+{
+	airfoilNameLength	= 64,
+};
+
+typedef struct
+{
+	char			airfoil[airfoilNameLength];
+	double			reynolds;
+	size_t			angleCount;
+	double *		angles;		/* ascending, as in CpLayout */
+	VelocityFactors *	factors;	/* per angle */
+} AirfoilEntry;
+
+typedef struct
+{
+	size_t		count;
+	AirfoilEntry *	entries;	/* sorted by airfoil, then Reynolds number */
+} AirfoilDatabase;
+
+int	airfoilDatabaseRead(const char * manifest, IntegrationMode mode, AirfoilDatabase * database);
+int	airfoilDatabaseLookup(const AirfoilDatabase * database, const char * airfoil, double reynolds, double angle,
+		VelocityFactors * factors, VelocityFactors * slopes);
+void	airfoilDatabaseFree(AirfoilDatabase * database);
+
+/*
+ *	Evaluation context: a resident Cp table and, for one weighting and integration mode, the velocity
+ *	factors of the expected lift over the weighted angles of attack, allocated from one arena sized when
+ *	the table is loaded, so that reconfiguring and evaluating make no heap allocation (lift-context.c).
+ */
+typedef struct
+{
+	LiftArena	arena;
+	CpTable		table;
+	int		embedded;	/* the table built into the model */
+	LiftArenaMark	loaded;		/* end of the table in the arena */
+	IntegrationMode	mode;
+	AngleWeights	weights;
+	int		weighted;	/* 0: all angles of attack equally likely, `weights` unused */
+	VelocityFactors	factors;
+} LiftContext;
+
+int	liftContextInit(LiftContext * context, const char * tableFile);
+int	liftContextConfigure(LiftContext * context, IntegrationMode mode, const AngleWeights * weights);
+double	liftContextLift(const LiftContext * context, const OperatingPoint * point);
+void	liftContextFree(LiftContext * context);
+
+/*
+ *	--serve: answer lift queries against an evaluation context, one request per line (lift-service.c).
+ */
+int	runService(LiftContext * context, FILE * input, FILE * output);
+
+/*
+ *	--bench: time each stage of the model separately and report, per stage, the total time, the time per
+ *	iteration (one evaluation for the evaluate stages) and the heap allocations per iteration, as
+ *	`;`-separated lines that can be diffed between builds (lift-bench.c).
+ */
+typedef struct
+{
+	const char *	name;
+	uint64_t	iterations;
+	uint64_t	startNanoseconds;
+	uint64_t	startAllocations;
+} BenchStage;
+
+extern volatile double	benchSink;
+
+uint64_t	monotonicNanoseconds(void);
+void		benchBegin(BenchStage * stage, const char * name, uint64_t iterations);
+void		benchEnd(const BenchStage * stage);
+void		benchHeader(const char * variant);
+
+/*
+ *	LIFT_TRACE builds: scoped timers and counters on the stages of every run, written with --trace as a
+ *	JSON summary or as Chrome trace events (lift-trace.c). A span runs from LIFT_TRACE_BEGIN() to
+ *	LIFT_TRACE_END(), and LIFT_TRACE_NEXT() ends one stage and starts the next with a single clock read;
+ *	in other builds the macros compile to nothing.
+ */
+typedef enum
+{
+	TraceStageRead,		/* opening and reading Cp files: CSV buffers, and binary tables */
+	TraceStageParse,	/* splitting CSV lines into numbers, per line */
+	TraceStageColumns,	/* the CSV row sinks: copies to store columns or running sums, per line */
+	TraceStageVelocity,	/* velocity factors of every angle of attack */
+	TraceStageJoint,	/* joint distribution of the factor samples */
+	TraceStageMonteCarlo,	/* monteCarloRun() */
+	TraceStageSamples,	/* evaluation and summary of one range of Monte Carlo samples */
+	TraceStageKernel,	/* batch kernel over one block of operating points */
+	traceStageCount,
+} TraceStage;
+
+typedef enum
+{
+	TraceCounterBytes,	/* read from Cp files */
+	TraceCounterLines,	/* of CSV files */
+	TraceCounterAngles,	/* whose velocity factors were computed */
+	TraceCounterSamples,	/* Monte Carlo samples evaluated */
+	TraceCounterPoints,	/* operating points through the batch kernel */
+	traceCounterCount,
+} TraceCounter;
+
+typedef enum
+{
+	TraceFormatJson,	/* totals per stage, and counters */
+	TraceFormatEvents,	/* Chrome trace-event JSON, for chrome://tracing or Perfetto */
+} TraceFormat;
+
+typedef struct
+{
+	TraceStage	stage;
+	uint64_t	startNanoseconds;
+} TraceSpan;
+
+int	parseTraceFormat(const char * name, TraceFormat * format);
+
+#if defined(LIFT_TRACE)
+TraceSpan	traceBegin(TraceStage stage);
+void		traceNext(TraceSpan * span, TraceStage stage);
+void		traceEnd(const TraceSpan * span);
+void		traceCount(TraceCounter counter, uint64_t count);
+int		traceWrite(const char * filename, TraceFormat format);
+
+#define LIFT_TRACE_BEGIN(span, stage)	TraceSpan span = traceBegin(stage)
+#define LIFT_TRACE_NEXT(span, stage)	traceNext(&(span), (stage))
+#define LIFT_TRACE_END(span)		traceEnd(&(span))
+#define LIFT_TRACE_COUNT(counter, count)	traceCount((counter), (count))
+#else
+#define LIFT_TRACE_BEGIN(span, stage)	((void) 0)
+#define LIFT_TRACE_NEXT(span, stage)	((void) 0)
+#define LIFT_TRACE_END(span)		((void) 0)
+#define LIFT_TRACE_COUNT(counter, count)	((void) 0)
+#endif
+
+/*
+ *	Model variants and the command line shared by all front-ends (lift-main.c).
+ */
+typedef enum
+{
+	ModelVariantNoUncertainties,		/* v1: point-valued operating point */
+	ModelVariantUncertainAtmosphere,	/* v2: uncertain elevation, temperature and humidity */
+	ModelVariantUncertainAngleOfAttack,	/* v3: uncertain angle of attack from a Cp table */
+} ModelVariant;
+
+typedef struct
+{
+	ModelVariant	variant;
+	const char *	tableFile;
+	int		batch;
+	const char *	batchFile;
+	int		threadCount;
+	SweepSchedule	schedule;
+	size_t		densityNodes[2];	/* h and T nodes of the density table; 0: exact density */
+	IntegrationMode	integration;
+	AngleWeights *	weights;		/* NULL: all angles of attack equally likely */
+	AngleWeights	angleWeights;
+	const char *	airfoilManifest;	/* airfoil database of v1 */
+	const char *	airfoil;
+	double		reynolds;
+	double		angleOfAttack;
+	const char *	specificationFile;	/* uncertainty specification of v2 */
+	const char *	scenario;		/* NULL: every scenario */
+	int		serve;
+	int		gradient;
+	uint64_t	samples;		/* Monte Carlo backend: samples per result; 0: the default */
+	uint64_t	seed;
+	MonteCarloSampler	sampler;
+	ResultFormat	resultFormat;		/* of v1's --batch */
+	KernelPrecision	precision;		/* of v1's --batch kernel */
+	int		gpu;			/* LIFT_CUDA: --gpu */
+	SweepGrid *	grid;			/* v1's --grid; NULL: none */
+	SweepGrid	sweepGrid;
+	uint64_t	shard;
+	uint64_t	shardCount;		/* 0: the whole grid */
+	const char *	summaryFile;		/* --grid: --summary */
+	const char *	traceFile;		/* LIFT_TRACE: --trace */
+	TraceFormat	traceFormat;
+	int		bench;
+	uint64_t	benchIterations;	/* 0: the variant's default */
+} ModelOptions;
+
+int	runNoUncertainties(const ModelOptions * options);
+int	runUncertainAtmosphere(const ModelOptions * options);
+int	runUncertainAngleOfAttack(const ModelOptions * options);
+int	liftMain(int argc, char * argv[], ModelVariant variant);
+
+#endif
@@ -0,0 +1,58 @@
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Cp table built into the model: the pressure coefficient distributions of v3/inputs/all_angles.csv
+ *	and their velocity factors, generated at build time by core/tools/lift-generate-cp-tables into
+ *	lift-cp-tables.h. Regenerate it whenever the CSV changes.
+ */
+#include "lift-cp-tables.h"
+
+/*
+ *	v1 and v2 use the curves at this angle of attack.
+ */
+static const double	embeddedAngle = 10.0;
+
+/*
+ *	View of the built-in table as a CpTable, for code that works on tables (e.g. v3 without an input
+ *	file). The view owns nothing and must not be passed to cpTableFree().
+ */
+void
+cpTableEmbedded(CpTable * table)
+{
+	memset(table, 0, sizeof(*table));
+	table->layout	= embeddedCpLayout;
+	table->rows	= embeddedCpRows;
+	table->columns	= embeddedCpColumns;
+	table->values	= embeddedCpValues;
+}
+
+/*
+ *	Velocity factors of the built-in curves at embeddedAngle, precomputed at build time.
+ */
+void
+precomputeEmbeddedVelocityFactors(VelocityFactors * factors)
+{
+	for (size_t k = 0; k < embeddedCpLayout.angleCount; k++)
+	{
+		if (embeddedCpLayout.angles[k] == embeddedAngle)
+		{
+			*factors = embeddedVelocityFactors[IntegrationMean][k];
+		}
+	}
+}
+
+/*
+ *	Slopes per degree of angle of attack of those factors, from the spline through the built-in curves.
+ */
+void
+embeddedVelocityFactorSlopes(VelocityFactors * slopes)
+{
+	CpTable		table;
+	CurvePlan	plan;
+
+	cpTableEmbedded(&table);
+	curvePlanInit(&plan, &table.layout, embeddedAngle, AngleInterpolationSpline);
+	slopes->over	= plannedVelocityFactorSlope(&table, &plan, CpSurfaceOver, IntegrationMean);
+	slopes->under	= plannedVelocityFactorSlope(&table, &plan, CpSurfaceUnder, IntegrationMean);
+}
@@ -0,0 +1,373 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+#if !defined(LIFT_NO_MMAP)
+#include <sys/mman.h>
+#endif
+
+/*
+ *	Binary Cp table (.cpt) file layout, in host byte order:
+ *	-	CpTableFileHeader
+ *	-	columns * cpTableNameLength bytes of NUL-padded column names
+ *	-	zero padding up to valuesOffset (a multiple of cpTableAlignment)
+ *	-	columns * rows doubles, column-major
+ *	so a mapped file is used in place, without parsing or copying.
+ */
+typedef struct
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrder;
+	uint64_t	columns;
+	uint64_t	rows;
+	uint64_t	valuesOffset;
+} CpTableFileHeader;
+
+static const char	cpTableMagic[8] = {'L', 'I', 'F', 'T', 'C', 'P', 'T', '\0'};
+
+const double *
+cpTableColumn(const CpTable * table, size_t column)
+{
+	return &table->values[column * table->rows];
+}
+
+const double *
+cpTableCurve(const CpTable * table, size_t angle, CpSurface surface)
+{
+	return cpTableColumn(table, 1 + 2 * (size_t) angle + surface);
+}
+
+size_t
+cpLayoutColumnCount(const CpLayout * layout)
+{
+	return 1 + 2 * layout->angleCount;
+}
+
+/*
+ *	Parse a `Curve<angle>` / `Curve<angle>l` column name. Returns 0 if `name` is not a curve.
+ */
+static int
+parseCurveName(const char * name, double * angle, CpSurface * surface)
+{
+	char *	end;
+
+	if (strncmp(name, "Curve", 5) != 0)
+	{
+		return 0;
+	}
+	*angle = strtod(name + 5, &end);
+	if (end == name + 5)
+	{
+		return 0;
+	}
+	if (strcmp(end, "l") == 0)
+	{
+		*surface = CpSurfaceUnder;
+		return 1;
+	}
+	*surface = CpSurfaceOver;
+
+	return *end == '\0';
+}
+
+static int
+compareAngles(const void * a, const void * b)
+{
+	double	x = *(const double *) a;
+	double	y = *(const double *) b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ *	Index of `angle` in the layout (binary search), or -1.
+ */
+static int
+cpLayoutAngleIndex(const CpLayout * layout, double angle)
+{
+	const double *	found = bsearch(&angle, layout->angles, layout->angleCount, sizeof(double), compareAngles);
+
+	return found == NULL ? -1 : (int) (found - layout->angles);
+}
+
+/*
+ *	Discover the angles of attack from a header. Every angle needs both its over and its under curve.
+ */
+int
+cpLayoutFromNames(CpLayout * layout, size_t columns, char (*names)[cpTableNameLength])
+{
+	unsigned char	seen[cpMaxAngles] = {0};
+	int		hasX = 0;
+
+	layout->angleCount = 0;
+	for (size_t j = 0; j < columns; j++)
+	{
+		double		angle;
+		CpSurface	surface;
+
+		hasX |= strcmp(names[j], "x") == 0;
+		if (parseCurveName(names[j], &angle, &surface) && surface == CpSurfaceOver)
+		{
+			if (layout->angleCount == cpMaxAngles)
+			{
+				return -1;
+			}
+			layout->angles[layout->angleCount++] = angle;
+		}
+	}
+	qsort(layout->angles, layout->angleCount, sizeof(double), compareAngles);
+
+	for (size_t j = 0; j < columns; j++)
+	{
+		double		angle;
+		CpSurface	surface;
+		int		index;
+
+		if (parseCurveName(names[j], &angle, &surface) && surface == CpSurfaceUnder)
+		{
+			index = cpLayoutAngleIndex(layout, angle);
+			if (index < 0)
+			{
+				return -1;
+			}
+			seen[index] = 1;
+		}
+	}
+	for (size_t k = 0; k < layout->angleCount; k++)
+	{
+		if (!seen[k] || (k > 0 && layout->angles[k] == layout->angles[k - 1]))
+		{
+			return -1;
+		}
+	}
+
+	return hasX && layout->angleCount > 0 ? 0 : -1;
+}
+
+/*
+ *	Store column of `name`, or -1 if it is not part of the store.
+ */
+int
+cpLayoutColumn(const CpLayout * layout, const char * name)
+{
+	double		angle;
+	CpSurface	surface;
+	int		index;
+
+	if (strcmp(name, "x") == 0)
+	{
+		return 0;
+	}
+	if (!parseCurveName(name, &angle, &surface) || (index = cpLayoutAngleIndex(layout, angle)) < 0)
+	{
+		return -1;
+	}
+
+	return 1 + 2 * index + surface;
+}
+
+void
+cpLayoutColumnName(const CpLayout * layout, size_t column, char name[cpTableNameLength])
+{
+	if (column == 0)
+	{
+		strcpy(name, "x");
+		return;
+	}
+	snprintf(name, cpTableNameLength, "Curve%g%s", layout->angles[(column - 1) / 2],
+		(column - 1) % 2 == CpSurfaceUnder ? "l" : "");
+}
+
+void
+cpTableFree(CpTable * table)
+{
+#if !defined(LIFT_NO_MMAP)
+	if (table->mapping != NULL)
+	{
+		munmap(table->mapping, table->mappingSize);
+	}
+#else
+	liftFree(table->mapping);
+#endif
+	liftFree(table->owned);
+	if (table->mapping == NULL)
+	{
+		liftFree(table->names);
+	}
+	memset(table, 0, sizeof(*table));
+}
+
+/*
+ *	Binary tables written by cpTableWrite() are already in store order and are used in place. Tables whose
+ *	columns come in another order are gathered into store order once, into `owned`.
+ */
+static int
+cpTableToStoreOrder(CpTable * table)
+{
+	size_t	columns;
+	int *	source;
+	int	ordered;
+
+	if (cpLayoutFromNames(&table->layout, table->columns, table->names) != 0)
+	{
+		return -1;
+	}
+	columns	= cpLayoutColumnCount(&table->layout);
+	ordered	= table->columns == columns;
+	source	= liftMalloc(columns * sizeof(int));
+	if (source == NULL)
+	{
+		return -1;
+	}
+	for (size_t j = 0; j < columns; j++)
+	{
+		source[j] = -1;
+	}
+	for (size_t j = 0; j < table->columns; j++)
+	{
+		int	target = cpLayoutColumn(&table->layout, table->names[j]);
+
+		if (target >= 0 && source[target] < 0)
+		{
+			source[target] = (int) j;
+			ordered &= target == (int) j;
+		}
+	}
+	if (ordered)
+	{
+		liftFree(source);
+		return 0;
+	}
+
+	table->owned = liftMalloc(columns * table->rows * sizeof(double));
+	if (table->owned == NULL)
+	{
+		liftFree(source);
+		return -1;
+	}
+	for (size_t j = 0; j < columns; j++)
+	{
+		memcpy(&table->owned[j * table->rows], cpTableColumn(table, source[j]), table->rows * sizeof(double));
+	}
+	liftFree(source);
+	table->values	= table->owned;
+	table->columns	= columns;
+
+	return 0;
+}
+
+static int
+mapTable(const char * filename, CpTable * table)
+{
+	CpTableFileHeader	header;
+	FILE *			file;
+	size_t			size;
+	size_t			namesEnd;
+
+	memset(table, 0, sizeof(*table));
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+	{
+		return -1;
+	}
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, cpTableMagic, sizeof(cpTableMagic)) != 0)
+	{
+		fclose(file);
+		return 1;
+	}
+	if (header.version != cpTableVersion || header.byteOrder != cpTableByteOrder ||
+		fseek(file, 0, SEEK_END) != 0)
+	{
+		fclose(file);
+		return -1;
+	}
+	size = (size_t) ftell(file);
+
+	namesEnd = sizeof(header) + header.columns * cpTableNameLength;
+	if (header.columns == 0 || header.valuesOffset < namesEnd || header.valuesOffset % cpTableAlignment != 0 ||
+		header.rows > (size - header.valuesOffset) / sizeof(double) / header.columns)
+	{
+		fclose(file);
+		return -1;
+	}
+
+#if !defined(LIFT_NO_MMAP)
+	table->mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	if (table->mapping == MAP_FAILED)
+	{
+		table->mapping = NULL;
+		fclose(file);
+		return -1;
+	}
+#else
+	table->mapping = liftMalloc(size);
+	if (table->mapping == NULL || fseek(file, 0, SEEK_SET) != 0 || fread(table->mapping, 1, size, file) != size)
+	{
+		liftFree(table->mapping);
+		table->mapping = NULL;
+		fclose(file);
+		return -1;
+	}
+#endif
+	fclose(file);
+
+	table->mappingSize	= size;
+	table->rows		= header.rows;
+	table->columns		= header.columns;
+	table->names		= (char (*)[cpTableNameLength]) ((char *) table->mapping + sizeof(header));
+	table->values		= (const double *) ((char *) table->mapping + header.valuesOffset);
+
+	return cpTableToStoreOrder(table);
+}
+
+/*
+ *	Map a binary Cp table. Returns 1 if `filename` is not a binary table (so the caller can fall back to
+ *	CSV), 0 on success and -1 on a malformed table.
+ */
+int
+cpTableMap(const char * filename, CpTable * table)
+{
+	int	status;
+
+	LIFT_TRACE_BEGIN(map, TraceStageRead);
+	status = mapTable(filename, table);
+	LIFT_TRACE_END(map);
+	LIFT_TRACE_COUNT(TraceCounterBytes, status == 0 ? table->mappingSize : 0);
+
+	return status;
+}
+
+/*
+ *	Write `table` in the binary format read by cpTableMap().
+ */
+int
+cpTableWrite(const CpTable * table, const char * filename)
+{
+	static const char	padding[cpTableAlignment] = {0};
+	CpTableFileHeader	header;
+	size_t			namesEnd	= sizeof(header) + table->columns * cpTableNameLength;
+	FILE *			file;
+	int			failed;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, cpTableMagic, sizeof(cpTableMagic));
+	header.version		= cpTableVersion;
+	header.byteOrder	= cpTableByteOrder;
+	header.columns		= table->columns;
+	header.rows		= table->rows;
+	header.valuesOffset	= (namesEnd + cpTableAlignment - 1) / cpTableAlignment * cpTableAlignment;
+
+	file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		return -1;
+	}
+	failed = fwrite(&header, sizeof(header), 1, file) != 1 ||
+		fwrite(table->names, cpTableNameLength, table->columns, file) != table->columns ||
+		fwrite(padding, 1, header.valuesOffset - namesEnd, file) != header.valuesOffset - namesEnd ||
+		fwrite(table->values, sizeof(double), table->rows * table->columns, file) != table->rows * table->columns;
+	failed |= fclose(file) != 0;
+
+	return failed ? -1 : 0;
+}
@@ -0,0 +1,173 @@
+/*
+ *	Generated by core/tools/lift-generate-cp-tables from v3/inputs/all_angles.csv; do not edit.
+ *	Data of the Cp table built into the model, included by lift-cp-embedded.c only.
+ */
+enum {
+	embeddedCpRows		= 139,
+	embeddedCpColumns	= 7,
+};
+
+static const CpLayout	embeddedCpLayout = {
+	.angleCount	= 3,
+	.angles		= {0, 5, 10},
+};
+
+/*
+ *	Column-major, in store order.
+ */
+static const double	embeddedCpValues[embeddedCpColumns * embeddedCpRows] = {
+	/* x */
+	0.015, 0.052, 0.124, 0.18, 0.367, 1.125, 1.217, 1.307,
+	1.602, 1.669, 1.678, 1.859, 2.329, 2.398, 3.094, 3.181,
+	3.228, 3.887, 3.945, 5.162, 5.475, 5.562, 5.989, 6.165,
+	6.357, 7.244, 8.661, 8.869, 8.929, 9.227, 10.185, 10.255,
+	10.651, 11.279, 11.342, 11.419, 12.334, 13.399, 13.682, 13.854,
+	15.591, 16.085, 16.471, 17.783, 18.594, 18.656, 18.877, 18.948,
+	20.185, 21, 21.495, 22.484, 23.617, 24.011, 24.994, 26.131,
+	26.527, 27.505, 27.66, 28.54, 28.936, 29.909, 31.051, 31.553,
+	31.722, 32.314, 33.456, 33.959, 34.718, 34.773, 35.966, 36.576,
+	37.123, 38.477, 39.088, 39.632, 40.617, 40.837, 40.988, 41.704,
+	42.141, 43.288, 44.11, 44.44, 44.931, 45.692, 46.62, 46.844,
+	48.097, 48.162, 48.574, 49.131, 49.144, 50.397, 51.549, 51.642,
+	52.907, 53.222, 54.164, 54.245, 54.26, 55.601, 55.733, 56.329,
+	56.677, 56.878, 58.351, 59.191, 59.392, 60.863, 61.808, 61.906,
+	62.311, 63.061, 64.215, 64.522, 65.467, 66.725, 67.033, 67.873,
+	69.235, 69.544, 70.28, 71.746, 71.951, 72.792, 74.462, 74.467,
+	74.762, 75.303, 75.597, 77.08, 77.292, 77.805, 77.815, 79.488,
+	79.7, 79.805, 80.748,
+	/* Curve0 */
+	1.0101, 0.9944, 0.9663, 0.9571, 0.9266, 0.7798, 0.7564, 0.7307,
+	0.623, 0.5918, 0.5871, 0.4848, 0.2307, 0.202, -0.0447, -0.0706,
+	-0.0841, -0.2395, -0.2498, -0.3649, -0.3786, -0.3821, -0.3989, -0.4059,
+	-0.4139, -0.4531, -0.5222, -0.533, -0.5361, -0.552, -0.6016, -0.6048,
+	-0.6213, -0.6382, -0.6392, -0.6401, -0.6393, -0.6243, -0.6202, -0.618,
+	-0.6051, -0.6012, -0.5969, -0.5723, -0.557, -0.5561, -0.553, -0.5522,
+	-0.5463, -0.5499, -0.5545, -0.5688, -0.592, -0.6011, -0.6249, -0.6511,
+	-0.6591, -0.6744, -0.6761, -0.6823, -0.683, -0.68, -0.6692, -0.6619,
+	-0.6591, -0.648, -0.6259, -0.6181, -0.6098, -0.6093, -0.601, -0.5969,
+	-0.5926, -0.5805, -0.5758, -0.5724, -0.5662, -0.5644, -0.5631, -0.5546,
+	-0.5472, -0.5207, -0.4995, -0.4914, -0.4798, -0.4631, -0.4444, -0.4401,
+	-0.4176, -0.4165, -0.4096, -0.4006, -0.4004, -0.382, -0.369, -0.3682,
+	-0.3603, -0.3593, -0.3583, -0.3583, -0.3583, -0.3622, -0.3629, -0.3667,
+	-0.3694, -0.3711, -0.3862, -0.3937, -0.3951, -0.3991, -0.3969, -0.3966,
+	-0.3947, -0.3901, -0.3793, -0.3754, -0.3609, -0.3376, -0.3317, -0.3158,
+	-0.2925, -0.2879, -0.2779, -0.2585, -0.2553, -0.2414, -0.2229, -0.2228,
+	-0.2225, -0.2242, -0.2259, -0.2356, -0.2362, -0.2361, -0.236, -0.2257,
+	-0.224, -0.2231, -0.2168,
+	/* Curve0l */
+	-0.0054, -0.009, -0.0151, -0.017, -0.0229, -0.0439, -0.0462, -0.0484,
+	-0.0556, -0.0572, -0.0574, -0.0618, -0.0735, -0.0753, -0.0953, -0.0981,
+	-0.0996, -0.1247, -0.1272, -0.1974, -0.2218, -0.2291, -0.2686, -0.2859,
+	-0.3053, -0.3926, -0.4946, -0.5044, -0.507, -0.5182, -0.5368, -0.5372,
+	-0.5374, -0.5319, -0.531, -0.5299, -0.5116, -0.4831, -0.4747, -0.4695,
+	-0.4158, -0.401, -0.3899, -0.356, -0.3393, -0.3382, -0.3345, -0.3334,
+	-0.3181, -0.3122, -0.3099, -0.3074, -0.3071, -0.3074, -0.3079, -0.307,
+	-0.3059, -0.2997, -0.2981, -0.2857, -0.2782, -0.2558, -0.2254, -0.212,
+	-0.2076, -0.1931, -0.1704, -0.1631, -0.1556, -0.1552, -0.1515, -0.1522,
+	-0.1537, -0.1603, -0.1639, -0.1673, -0.1734, -0.1747, -0.1756, -0.1793,
+	-0.1813, -0.1847, -0.1852, -0.1848, -0.1836, -0.1798, -0.1726, -0.1705,
+	-0.1561, -0.1553, -0.1498, -0.1419, -0.1417, -0.1228, -0.1053, -0.104,
+	-0.0871, -0.0837, -0.0762, -0.0758, -0.0758, -0.0764, -0.0771, -0.0816,
+	-0.085, -0.0872, -0.1051, -0.115, -0.1172, -0.13, -0.1352, -0.1356,
+	-0.1369, -0.1383, -0.1383, -0.138, -0.1362, -0.1323, -0.1312, -0.1277,
+	-0.1212, -0.1196, -0.1155, -0.1069, -0.1057, -0.1004, -0.0894, -0.0894,
+	-0.0874, -0.0838, -0.0818, -0.0716, -0.0701, -0.0666, -0.0665, -0.0549,
+	-0.0535, -0.0528, -0.0464,
+	/* Curve5 */
+	0.5464, 0.5477, 0.5519, 0.5536, 0.5585, 0.5078, 0.477, 0.4335,
+	0.1908, 0.1234, 0.1139, -0.0631, -0.4872, -0.5454, -1.0978, -1.1602,
+	-1.1904, -1.3531, -1.3582, -1.4133, -1.4198, -1.4212, -1.426, -1.427,
+	-1.4273, -1.4207, -1.4057, -1.4061, -1.4065, -1.4095, -1.4263, -1.4274,
+	-1.4321, -1.4301, -1.429, -1.4274, -1.3925, -1.3335, -1.3185, -1.3099,
+	-1.2447, -1.2294, -1.2174, -1.1763, -1.1517, -1.1499, -1.1435, -1.1415,
+	-1.1107, -1.0966, -1.0909, -1.0851, -1.0868, -1.0894, -1.0989, -1.1108,
+	-1.1139, -1.1172, -1.117, -1.1122, -1.1077, -1.092, -1.0684, -1.0572,
+	-1.0534, -1.0398, -1.0133, -1.0016, -0.9845, -0.9833, -0.9582, -0.9465,
+	-0.9368, -0.9144, -0.9047, -0.8959, -0.8783, -0.8738, -0.8706, -0.8536,
+	-0.8416, -0.8041, -0.7731, -0.7604, -0.7418, -0.7151, -0.6876, -0.6815,
+	-0.6486, -0.6469, -0.6352, -0.6188, -0.6184, -0.5821, -0.5525, -0.5503,
+	-0.5271, -0.5262, -0.5391, -0.5393, -0.5393, -0.5332, -0.5325, -0.5298,
+	-0.5292, -0.5293, -0.5372, -0.5419, -0.5424, -0.5391, -0.5321, -0.5312,
+	-0.5272, -0.5181, -0.4996, -0.4937, -0.4737, -0.4445, -0.4371, -0.4174,
+	-0.3894, -0.3842, -0.3736, -0.3569, -0.3548, -0.3459, -0.3246, -0.3246,
+	-0.32, -0.3111, -0.3062, -0.2835, -0.281, -0.2762, -0.2761, -0.271,
+	-0.271, -0.271, -0.27,
+	/* Curve5l */
+	1.1366, 1.1098, 1.0615, 1.0458, 0.9941, 0.7866, 0.7623, 0.7386,
+	0.6635, 0.647, 0.6447, 0.6013, 0.4977, 0.4838, 0.3658, 0.3543,
+	0.3485, 0.2888, 0.2853, 0.2534, 0.2515, 0.2511, 0.2476, 0.2451,
+	0.2414, 0.2155, 0.1679, 0.1618, 0.1601, 0.1521, 0.131, 0.1298,
+	0.1234, 0.1153, 0.1146, 0.1138, 0.106, 0.1004, 0.0994, 0.0989,
+	0.0967, 0.0968, 0.0972, 0.0993, 0.1013, 0.1015, 0.1021, 0.1023,
+	0.1062, 0.1091, 0.1108, 0.1143, 0.1181, 0.1194, 0.1222, 0.1248,
+	0.1255, 0.1267, 0.1268, 0.1269, 0.1267, 0.1251, 0.1212, 0.1187,
+	0.1177, 0.1136, 0.1031, 0.0975, 0.0881, 0.0874, 0.0708, 0.062,
+	0.0541, 0.0363, 0.03, 0.0257, 0.0221, 0.0221, 0.0224, 0.0256,
+	0.029, 0.0423, 0.0545, 0.0598, 0.0679, 0.0806, 0.0948, 0.0977,
+	0.1083, 0.1084, 0.1079, 0.1035, 0.1034, 0.0827, 0.0603, 0.0586,
+	0.0385, 0.0344, 0.0242, 0.0235, 0.0233, 0.0138, 0.0131, 0.0105,
+	0.0093, 0.0087, 0.006, 0.0055, 0.0054, 0.0062, 0.0073, 0.0075,
+	0.0081, 0.0095, 0.0121, 0.0129, 0.0154, 0.0191, 0.0201, 0.0228,
+	0.0274, 0.0285, 0.0312, 0.0366, 0.0374, 0.0406, 0.047, 0.047,
+	0.0482, 0.0502, 0.0514, 0.0571, 0.0579, 0.0598, 0.0598, 0.066,
+	0.0668, 0.0672, 0.0705,
+	/* Curve10 */
+	-2.3195, -2.3347, -2.3617, -2.3704, -2.399, -2.5187, -2.5338, -2.5489,
+	-2.5998, -2.6117, -2.6134, -2.6457, -2.7171, -2.7249, -2.7597, -2.7589,
+	-2.758, -2.7244, -2.72, -2.6018, -2.5681, -2.5571, -2.5044, -2.4834,
+	-2.4609, -2.3657, -2.2605, -2.2493, -2.2462, -2.2312, -2.1841, -2.1805,
+	-2.1589, -2.1186, -2.114, -2.1081, -2.0262, -1.9285, -1.9076, -1.8958,
+	-1.7941, -1.7624, -1.7362, -1.6485, -1.6023, -1.599, -1.5876, -1.584,
+	-1.5255, -1.4903, -1.4706, -1.4364, -1.4062, -1.3978, -1.3814, -1.3689,
+	-1.3646, -1.3489, -1.3453, -1.3197, -1.3061, -1.2711, -1.2334, -1.2176,
+	-1.2122, -1.1934, -1.1557, -1.1393, -1.1157, -1.1141, -1.081, -1.0646,
+	-1.0492, -1.0076, -0.9884, -0.9715, -0.9422, -0.9357, -0.9312, -0.9087,
+	-0.8939, -0.8496, -0.817, -0.8048, -0.7878, -0.7634, -0.7343, -0.727,
+	-0.6839, -0.6817, -0.6676, -0.6496, -0.6492, -0.6134, -0.5828, -0.5803,
+	-0.5464, -0.5385, -0.5175, -0.5159, -0.5156, -0.4959, -0.4948, -0.492,
+	-0.4917, -0.4919, -0.4962, -0.4961, -0.4956, -0.4864, -0.4774, -0.4764,
+	-0.4723, -0.465, -0.4437, -0.4381, -0.4212, -0.3986, -0.393, -0.3773,
+	-0.3596, -0.3554, -0.3448, -0.3324, -0.3307, -0.3236, -0.3021, -0.3021,
+	-0.2983, -0.2911, -0.289, -0.2767, -0.2749, -0.2701, -0.27, -0.2705,
+	-0.2708, -0.2711, -0.2829,
+	/* Curve10l */
+	0.8701, 1.0286, 1.0449, 1.0475, 1.0516, 1.0353, 1.0315, 1.0275,
+	1.0132, 1.0097, 1.0092, 0.9994, 0.9723, 0.9682, 0.9248, 0.9193,
+	0.9163, 0.8734, 0.8696, 0.7894, 0.769, 0.7633, 0.7357, 0.7245,
+	0.7123, 0.658, 0.5827, 0.5736, 0.5711, 0.5596, 0.534, 0.533,
+	0.559, 0.4381, 0.4371, 0.4359, 0.4224, 0.4087, 0.4054, 0.4034,
+	0.3844, 0.3794, 0.3756, 0.3631, 0.3557, 0.3552, 0.3532, 0.3526,
+	0.3419, 0.3351, 0.331, 0.3231, 0.3143, 0.3114, 0.304, 0.2958,
+	0.293, 0.2862, 0.2851, 0.2792, 0.2765, 0.2702, 0.2629, 0.2598,
+	0.2588, 0.2552, 0.2485, 0.2457, 0.2414, 0.2411, 0.2348, 0.2317,
+	0.229, 0.2227, 0.2201, 0.2179, 0.2143, 0.2136, 0.2131, 0.2111,
+	0.2101, 0.2082, 0.2077, 0.2078, 0.2084, 0.2102, 0.2149, 0.2166,
+	0.2321, 0.2328, 0.2324, 0.2227, 0.2224, 0.1953, 0.1729, 0.1713,
+	0.1511, 0.1467, 0.135, 0.1341, 0.1339, 0.1208, 0.1197, 0.1151,
+	0.1127, 0.1114, 0.1035, 0.1001, 0.0994, 0.0951, 0.093, 0.0928,
+	0.0921, 0.091, 0.0897, 0.0895, 0.0889, 0.0885, 0.0885, 0.0885,
+	0.0888, 0.0889, 0.0892, 0.09, 0.0902, 0.0907, 0.092, 0.092,
+	0.0922, 0.0926, 0.0929, 0.0941, 0.0942, 0.0946, 0.0946, 0.0958,
+	0.0959, 0.096, 0.0965,
+};
+
+/*
+ *	Velocity factors per integration mode and angle of attack.
+ */
+static const VelocityFactors	embeddedVelocityFactors[][3] = {
+	[IntegrationMean] = {
+		{.under = 1.091588465670889, .over = 1.130499923723186},	/* 0° */
+		{.under = 0.9035106727084601, .over = 1.3034201728182686},	/* 5° */
+		{.under = 0.7648238218038593, .over = 1.4828977097921605},	/* 10° */
+	},
+	[IntegrationTrapezoid] = {
+		{.under = 1.0951588603218099, .over = 1.184600143631799},	/* 0° */
+		{.under = 0.9412098490048544, .over = 1.3296507413725944},	/* 5° */
+		{.under = 0.8282577742779432, .over = 1.429826175989618},	/* 10° */
+	},
+	[IntegrationSimpson] = {
+		{.under = 1.0951872656286674, .over = 1.18472312105145},	/* 0° */
+		{.under = 0.9415607146681627, .over = 1.329532242280896},	/* 5° */
+		{.under = 0.8283021907130111, .over = 1.4297880591888217},	/* 10° */
+	},
+};
@@ -0,0 +1,480 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Streaming CSV reader.
+ *
+ *	streamCsv() reads the file once, through a fixed-size buffer that only grows to fit the longest line,
+ *	and hands every row to a CsvSink as it is parsed, so the file is never held in memory. The first
+ *	non-empty line is the header and fixes the number of columns. Fields are separated by `;` (with `,`
+ *	or `.` as the decimal separator), or by `,` or a tab when the header contains no `;` (with `.` as the
+ *	decimal separator).
+ */
+enum {
+	csvBufferSize	= 1 << 16,
+	csvFieldLength	= 64,
+};
+
+static char
+csvSeparator(const char * header)
+{
+	if (strchr(header, ';') != NULL)
+	{
+		return ';';
+	}
+
+	return strchr(header, ',') != NULL ? ',' : '\t';
+}
+
+static size_t
+csvFieldCount(const char * line, char separator)
+{
+	size_t	count = 1;
+
+	for (; *line != '\0'; line++)
+	{
+		count += *line == separator;
+	}
+
+	return count;
+}
+
+/*
+ *	Parse the fields of `line` into names (header) or values (data row). Returns the number of fields,
+ *	or 0 for a field that is not a number.
+ */
+static size_t
+csvSplit(char * line, char separator, size_t columns, char (*names)[cpTableNameLength], double * values)
+{
+	size_t	field = 0;
+	char *	start = line;
+
+	for (;;)
+	{
+		char *	end = strchr(start, separator);
+		size_t	length;
+
+		if (end == NULL)
+		{
+			end = start + strlen(start);
+		}
+		while (start < end && (*start == ' ' || *start == '"'))
+		{
+			start++;
+		}
+		length = end - start;
+		while (length > 0 && (start[length - 1] == ' ' || start[length - 1] == '"'))
+		{
+			length--;
+		}
+
+		if (field < columns && names != NULL)
+		{
+			size_t	copied = length < cpTableNameLength - 1 ? length : cpTableNameLength - 1;
+
+			memcpy(names[field], start, copied);
+			names[field][copied] = '\0';
+		}
+		else if (field < columns)
+		{
+			char	number[csvFieldLength];
+			char *	parsed;
+
+			if (length == 0 || length >= csvFieldLength)
+			{
+				return 0;
+			}
+			for (size_t i = 0; i < length; i++)
+			{
+				number[i] = (start[i] == ',' && separator != ',') ? '.' : start[i];
+			}
+			number[length] = '\0';
+			values[field] = strtod(number, &parsed);
+			if (*parsed != '\0')
+			{
+				return 0;
+			}
+		}
+
+		field++;
+		if (*end == '\0')
+		{
+			return field;
+		}
+		start = end + 1;
+	}
+}
+
+int
+streamCsv(FILE * file, const CsvSink * sink)
+{
+	size_t		capacity	= csvBufferSize;
+	size_t		length		= 0;
+	size_t		columns		= 0;
+	size_t		lineNumber	= 0;
+	char		separator	= ';';
+	char *		buffer		= liftMalloc(capacity);
+	char		(*names)[cpTableNameLength] = NULL;
+	double *	values		= NULL;
+	int		status		= 0;
+	int		atEnd		= 0;
+
+	if (buffer == NULL)
+	{
+		return -1;
+	}
+
+	while (status == 0 && !atEnd)
+	{
+		size_t	consumed = 0;
+		size_t	filled;
+		char *	newline;
+
+		/*
+		 *	Two bytes stay free: one for the '\n' added to a last line without one, one for the '\0'.
+		 */
+		if (capacity - length <= 2)
+		{
+			char *	grown = liftRealloc(buffer, capacity * 2);
+
+			if (grown == NULL)
+			{
+				status = -1;
+				break;
+			}
+			buffer = grown;
+			capacity *= 2;
+		}
+		LIFT_TRACE_BEGIN(fill, TraceStageRead);
+		filled = fread(buffer + length, 1, capacity - length - 2, file);
+		LIFT_TRACE_END(fill);
+		LIFT_TRACE_COUNT(TraceCounterBytes, filled);
+		length += filled;
+		atEnd = feof(file) || ferror(file);
+		if (atEnd && length > 0 && buffer[length - 1] != '\n')
+		{
+			buffer[length++] = '\n';
+		}
+		buffer[length] = '\0';
+
+		while (status == 0 && (newline = memchr(buffer + consumed, '\n', length - consumed)) != NULL)
+		{
+			char *	line = buffer + consumed;
+
+			consumed = newline - buffer + 1;
+			*newline = '\0';
+			while (newline > line && newline[-1] == '\r')
+			{
+				*--newline = '\0';
+			}
+			lineNumber++;
+			if (line[0] == '\0')
+			{
+				continue;
+			}
+
+			LIFT_TRACE_BEGIN(row, TraceStageParse);
+			if (names == NULL)
+			{
+				separator	= csvSeparator(line);
+				columns		= csvFieldCount(line, separator);
+				names		= liftCalloc(columns, cpTableNameLength);
+				values		= liftCalloc(columns, sizeof(double));
+				if (names == NULL || values == NULL)
+				{
+					status = -1;
+					break;
+				}
+				csvSplit(line, separator, columns, names, NULL);
+				status = sink->header(sink->context, columns, names);
+			}
+			else if (csvSplit(line, separator, columns, NULL, values) != columns)
+			{
+				fprintf(stderr, "line %zu: expected %zu numeric fields\n", lineNumber, columns);
+				status = -1;
+			}
+			else
+			{
+				LIFT_TRACE_NEXT(row, TraceStageColumns);
+				status = sink->row(sink->context, values);
+			}
+			LIFT_TRACE_END(row);
+		}
+
+		memmove(buffer, buffer + consumed, length - consumed);
+		length -= consumed;
+	}
+
+	LIFT_TRACE_COUNT(TraceCounterLines, lineNumber);
+	if (ferror(file) || (status == 0 && names == NULL))
+	{
+		status = -1;
+	}
+	liftFree(buffer);
+	liftFree(names);
+	liftFree(values);
+
+	return status;
+}
+
+/*
+ *	Discover the layout of a header and map file columns to store columns for the sinks below; columns
+ *	that are not part of the store are skipped.
+ */
+static int *
+csvStoreSlots(CpLayout * layout, size_t columns, char (*names)[cpTableNameLength])
+{
+	int *	slot;
+	size_t	found = 0;
+
+	if (cpLayoutFromNames(layout, columns, names) != 0 || (slot = liftMalloc(columns * sizeof(int))) == NULL)
+	{
+		return NULL;
+	}
+	for (size_t j = 0; j < columns; j++)
+	{
+		slot[j] = cpLayoutColumn(layout, names[j]);
+		for (size_t i = 0; i < j && slot[j] >= 0; i++)
+		{
+			slot[j] = slot[i] == slot[j] ? -1 : slot[j];
+		}
+		found += slot[j] >= 0;
+	}
+	if (found != cpLayoutColumnCount(layout))
+	{
+		liftFree(slot);
+		return NULL;
+	}
+
+	return slot;
+}
+
+
+static void
+cpColumnStatisticsAdd(CpColumnStatistics * statistics, double x, double value)
+{
+	double	delta = value - statistics->mean;
+
+	if (statistics->count == 0 || value < statistics->min)
+	{
+		statistics->min = value;
+	}
+	if (statistics->count == 0 || value > statistics->max)
+	{
+		statistics->max = value;
+	}
+	statistics->count++;
+	statistics->mean	+= delta / statistics->count;
+	statistics->m2		+= delta * (value - statistics->mean);
+	velocityIntegralAdd(&statistics->integral, x, value);
+}
+
+static int
+statisticsHeader(void * context, size_t columns, char (*names)[cpTableNameLength])
+{
+	CpStatistics *	statistics = context;
+
+	statistics->fileColumns	= columns;
+	statistics->slot	= csvStoreSlots(&statistics->layout, columns, names);
+	if (statistics->slot == NULL)
+	{
+		return -1;
+	}
+	for (size_t j = 0; j < columns; j++)
+	{
+		if (statistics->slot[j] == 0)
+		{
+			statistics->xColumn = j;
+		}
+	}
+	statistics->columns	= liftCalloc(cpLayoutColumnCount(&statistics->layout), sizeof(CpColumnStatistics));
+
+	return statistics->columns == NULL ? -1 : 0;
+}
+
+static int
+statisticsRow(void * context, const double * values)
+{
+	CpStatistics *	statistics = context;
+
+	for (size_t j = 0; j < statistics->fileColumns; j++)
+	{
+		if (statistics->slot[j] >= 0)
+		{
+			cpColumnStatisticsAdd(&statistics->columns[statistics->slot[j]], values[statistics->xColumn], values[j]);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ *	Accumulate the per-column statistics of a CSV Cp table in a single pass, in memory independent of the
+ *	number of stations.
+ */
+int
+cpStatisticsReadCsv(const char * filename, CpStatistics * statistics)
+{
+	CsvSink	sink = {
+		.header		= statisticsHeader,
+		.row		= statisticsRow,
+		.context	= statistics,
+	};
+	FILE *	file;
+	int	status;
+
+	memset(statistics, 0, sizeof(*statistics));
+	LIFT_TRACE_BEGIN(open, TraceStageRead);
+	file = fopen(filename, "r");
+	LIFT_TRACE_END(open);
+	if (file == NULL)
+	{
+		return -1;
+	}
+	status = streamCsv(file, &sink);
+	fclose(file);
+	liftFree(statistics->slot);
+	statistics->slot = NULL;
+
+	if (status != 0 || statistics->columns == NULL || statistics->columns[0].count == 0)
+	{
+		liftFree(statistics->columns);
+		statistics->columns = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ *	Sink building a CpTable. Each store column holds `capacity` stations while the table grows; the
+ *	columns are packed to `rows` stations once the whole file is read.
+ */
+typedef struct
+{
+	CpTable *	table;
+	size_t		fileColumns;
+	size_t		capacity;
+	int *		slot;
+} CpTableBuilder;
+
+static int
+tableHeader(void * context, size_t columns, char (*names)[cpTableNameLength])
+{
+	CpTableBuilder *	builder = context;
+
+	builder->fileColumns	= columns;
+	builder->slot		= csvStoreSlots(&builder->table->layout, columns, names);
+	if (builder->slot == NULL)
+	{
+		return -1;
+	}
+	builder->table->columns	= cpLayoutColumnCount(&builder->table->layout);
+	builder->table->names	= liftCalloc(builder->table->columns, cpTableNameLength);
+	if (builder->table->names == NULL)
+	{
+		return -1;
+	}
+	for (size_t j = 0; j < columns; j++)
+	{
+		if (builder->slot[j] >= 0)
+		{
+			strcpy(builder->table->names[builder->slot[j]], names[j]);
+		}
+	}
+
+	return 0;
+}
+
+static int
+tableRow(void * context, const double * values)
+{
+	CpTableBuilder *	builder	= context;
+	CpTable *		table	= builder->table;
+
+	if (table->rows == builder->capacity)
+	{
+		size_t		capacity	= builder->capacity == 0 ? 256 : builder->capacity * 2;
+		double *	grown		= liftRealloc(table->owned, table->columns * capacity * sizeof(double));
+
+		if (grown == NULL)
+		{
+			return -1;
+		}
+		for (size_t j = table->columns - 1; j > 0; j--)
+		{
+			memmove(&grown[j * capacity], &grown[j * builder->capacity], table->rows * sizeof(double));
+		}
+		table->owned		= grown;
+		builder->capacity	= capacity;
+	}
+
+	for (size_t j = 0; j < builder->fileColumns; j++)
+	{
+		if (builder->slot[j] >= 0)
+		{
+			table->owned[builder->slot[j] * builder->capacity + table->rows] = values[j];
+		}
+	}
+	table->rows++;
+
+	return 0;
+}
+
+/*
+ *	Read a CSV Cp table of any number of stations into store order, writing every value straight to its
+ *	place in the store whatever the order of the columns in the file.
+ */
+int
+cpTableReadCsv(const char * filename, CpTable * table)
+{
+	CpTableBuilder	builder = {
+		.table		= table,
+	};
+	CsvSink		sink = {
+		.header		= tableHeader,
+		.row		= tableRow,
+		.context	= &builder,
+	};
+	FILE *		file;
+	int		status;
+
+	memset(table, 0, sizeof(*table));
+	LIFT_TRACE_BEGIN(open, TraceStageRead);
+	file = fopen(filename, "r");
+	LIFT_TRACE_END(open);
+	if (file == NULL)
+	{
+		return -1;
+	}
+	status		= streamCsv(file, &sink);
+	fclose(file);
+	liftFree(builder.slot);
+
+	if (status != 0 || table->rows == 0)
+	{
+		cpTableFree(table);
+		return -1;
+	}
+	LIFT_TRACE_BEGIN(pack, TraceStageColumns);
+	for (size_t j = 1; j < table->columns; j++)
+	{
+		memmove(&table->owned[j * table->rows], &table->owned[j * builder.capacity], table->rows * sizeof(double));
+	}
+	LIFT_TRACE_END(pack);
+	table->values = table->owned;
+
+	return 0;
+}
+
+/*
+ *	Load a binary Cp table in place, or read a CSV one into memory.
+ */
+int
+cpTableLoad(const char * filename, CpTable * table)
+{
+	int	status = cpTableMap(filename, table);
+
+	return status == 1 ? cpTableReadCsv(filename, table) : status;
+}
@@ -0,0 +1,579 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime.h>
+
+extern "C" {
+#include "lift-core.h"
+}
+
+#if defined(LIFT_CUDA)
+/*
+ *	CUDA offload of the batch kernel and of Monte Carlo runs, for LIFT_CUDA builds (nvcc -DLIFT_CUDA).
+ *
+ *	Batches: the points of a block go to the device in chunks of gpuBatchChunk that alternate between
+ *	two streams, staged through pinned buffers so that the copies are asynchronous: while one stream's
+ *	kernel runs, the other's inputs go up and its lift comes back, and the host fills the next staging
+ *	buffer meanwhile. The device evaluates airDensity() and computeLift() as written, with the device
+ *	libm, so its lift agrees with the host's to a few ulp rather than bit for bit.
+ *
+ *	Monte Carlo: a MonteCarloModel (lift-core.h) is evaluated entirely on the device, the samples never
+ *	leaving it. Each thread draws its samples with the same Philox4x32-10 coordinates as the random
+ *	sampler of lift-monte-carlo.c (sample i of dimension d is the same number on both), folds them into
+ *	running moments and adds them to the sketch buckets of a device-resident StreamingSummary with
+ *	atomics. Each launch ends with a block-wide reduction of the moments, whose per-block results come
+ *	back while the next launch runs on the other stream and are merged on the host in launch order, so a
+ *	run gives the same summary on every run of the same device, whatever the timing.
+ */
+enum
+{
+	gpuThreadsPerBlock	= 256,
+	gpuBatchChunk		= 16384,
+	gpuSamplesPerThread	= 64,
+	gpuMonteCarloLaunch	= 1 << 24,	/* samples per kernel launch */
+	gpuStreamCount		= 2,
+};
+
+typedef struct
+{
+	cudaStream_t	stream;
+	double *	staging;	/* pinned: V, h, T, Rh, A and lift, gpuBatchChunk each */
+	double *	device;		/* the same columns on the device */
+	size_t		begin;		/* of the chunk in flight */
+	size_t		count;		/* 0: idle */
+} GpuBatchStream;
+
+struct GpuDevice
+{
+	GpuBatchStream	streams[gpuStreamCount];
+};
+
+/*
+ *	Running moments of a set of values, merged with Chan et al.'s formula as in streamingSummaryMerge().
+ */
+typedef struct
+{
+	uint64_t	count;
+	double		mean;
+	double		m2;
+	double		min;
+	double		max;
+	uint64_t	zeroCount;
+} GpuMoments;
+
+/*
+ *	A MonteCarloModel with its factor samples on the device, and the run's key and sketch scale.
+ */
+typedef struct
+{
+	MonteCarloModel	model;
+	uint32_t	key[2];
+	double		inverseLogGamma;
+} GpuMonteCarloRun;
+
+static __constant__ GpuMonteCarloRun	deviceRun;
+
+static __device__ double
+deviceAirDensity(double h, double T, double Rh)
+{
+	double	Pair	= exp((-9.81 * 0.0289644 * h) / (8.31432 * (T + 273.15))) * 101325.0;
+	double	Psat	= 6.1078 * pow(10.0, 7.5 * T / (T + 237.3));
+	double	Pv	= Psat * Rh;
+	double	Pd	= Pair - Pv;
+
+	return (Pd / (287.058 * (T + 273.15))) + (Pv / (461.495 * (T + 273.15)));
+}
+
+static __device__ double
+deviceLift(double V, double h, double T, double Rh, double A, double under, double over)
+{
+	double	r	= deviceAirDensity(h, T, Rh);
+	double	v1	= V * under;
+	double	v2	= V * over;
+
+	return r * A * (v2 * v2 - v1 * v1) / 2.0;
+}
+
+static __global__ void
+liftBatchKernel(size_t count, const double * V, const double * h, const double * T, const double * Rh,
+		const double * A, double under, double over, double * lift)
+{
+	for (size_t i = blockIdx.x * (size_t) blockDim.x + threadIdx.x; i < count; i += (size_t) gridDim.x * blockDim.x)
+	{
+		lift[i] = deviceLift(V[i], h[i], T[i], Rh[i], A[i], under, over);
+	}
+}
+
+/*
+ *	Open the first CUDA device with the batch streams and their buffers. Returns NULL if there is none
+ *	or it cannot be set up.
+ */
+GpuDevice *
+gpuOpen(void)
+{
+	GpuDevice *	device;
+	int		count = 0;
+
+	if (cudaGetDeviceCount(&count) != cudaSuccess || count == 0 || cudaSetDevice(0) != cudaSuccess)
+	{
+		return NULL;
+	}
+	device = (GpuDevice *) liftCalloc(1, sizeof(*device));
+	if (device == NULL)
+	{
+		return NULL;
+	}
+	for (int s = 0; s < gpuStreamCount; s++)
+	{
+		GpuBatchStream *	stream = &device->streams[s];
+
+		if (cudaStreamCreateWithFlags(&stream->stream, cudaStreamNonBlocking) != cudaSuccess ||
+			cudaMallocHost((void **) &stream->staging, 6 * gpuBatchChunk * sizeof(double)) != cudaSuccess ||
+			cudaMalloc((void **) &stream->device, 6 * gpuBatchChunk * sizeof(double)) != cudaSuccess)
+		{
+			gpuClose(device);
+			return NULL;
+		}
+	}
+
+	return device;
+}
+
+void
+gpuClose(GpuDevice * device)
+{
+	if (device == NULL)
+	{
+		return;
+	}
+	for (int s = 0; s < gpuStreamCount; s++)
+	{
+		GpuBatchStream *	stream = &device->streams[s];
+
+		if (stream->stream != NULL)
+		{
+			cudaStreamSynchronize(stream->stream);
+			cudaStreamDestroy(stream->stream);
+		}
+		cudaFree(stream->device);
+		cudaFreeHost(stream->staging);
+	}
+	liftFree(device);
+}
+
+/*
+ *	Wait for the chunk in flight on `stream`, if any, and copy its lift out of the staging buffer.
+ */
+static int
+retireChunk(GpuBatchStream * stream, double * lift)
+{
+	if (stream->count == 0)
+	{
+		return 0;
+	}
+	if (cudaStreamSynchronize(stream->stream) != cudaSuccess)
+	{
+		return -1;
+	}
+	memcpy(&lift[stream->begin], &stream->staging[5 * gpuBatchChunk], stream->count * sizeof(double));
+	stream->count = 0;
+
+	return 0;
+}
+
+/*
+ *	lift[i] of the `count` points on the device, as liftKernel(). Returns 0, or -1 on a device error.
+ */
+int
+gpuLiftBatch(GpuDevice * device, size_t count, const double * V, const double * h, const double * T,
+		const double * Rh, const double * A, const VelocityFactors * factors, double * lift)
+{
+	const double *	columns[] = {V, h, T, Rh, A};
+	int		status = 0;
+	size_t		chunkIndex = 0;
+
+	for (size_t begin = 0; status == 0 && begin < count; begin += gpuBatchChunk, chunkIndex++)
+	{
+		GpuBatchStream *	stream = &device->streams[chunkIndex % gpuStreamCount];
+		size_t			chunk = count - begin < (size_t) gpuBatchChunk ? count - begin : (size_t) gpuBatchChunk;
+		int			blocks = (int) ((chunk + gpuThreadsPerBlock - 1) / gpuThreadsPerBlock);
+		double *		d = stream->device;
+
+		if (retireChunk(stream, lift) != 0)
+		{
+			status = -1;
+			break;
+		}
+		for (int c = 0; c < 5; c++)
+		{
+			memcpy(&stream->staging[c * gpuBatchChunk], &columns[c][begin], chunk * sizeof(double));
+		}
+		if (cudaMemcpyAsync(d, stream->staging, 5 * gpuBatchChunk * sizeof(double), cudaMemcpyHostToDevice,
+				stream->stream) != cudaSuccess)
+		{
+			status = -1;
+			break;
+		}
+		liftBatchKernel<<<blocks, gpuThreadsPerBlock, 0, stream->stream>>>(chunk, d, d + gpuBatchChunk,
+				d + 2 * gpuBatchChunk, d + 3 * gpuBatchChunk, d + 4 * gpuBatchChunk, factors->under,
+				factors->over, d + 5 * gpuBatchChunk);
+		if (cudaGetLastError() != cudaSuccess ||
+			cudaMemcpyAsync(&stream->staging[5 * gpuBatchChunk], d + 5 * gpuBatchChunk, chunk * sizeof(double),
+				cudaMemcpyDeviceToHost, stream->stream) != cudaSuccess)
+		{
+			status = -1;
+			break;
+		}
+		stream->begin	= begin;
+		stream->count	= chunk;
+	}
+	for (int s = 0; s < gpuStreamCount; s++)
+	{
+		if (retireChunk(&device->streams[s], lift) != 0)
+		{
+			status = -1;
+		}
+	}
+
+	return status;
+}
+
+#if LIFT_MONTE_CARLO
+/*
+ *	Random sampler of lift-monte-carlo.c: Philox4x32-10 keyed by the seed, counted by (dimension, 0, sample).
+ */
+static __device__ double
+deviceUniform(uint32_t dimension, uint64_t sample)
+{
+	uint32_t	counter[4] = {dimension, 0, (uint32_t) sample, (uint32_t) (sample >> 32)};
+	uint32_t	k0 = deviceRun.key[0];
+	uint32_t	k1 = deviceRun.key[1];
+
+	for (int round = 0; round < 10; round++)
+	{
+		uint32_t	high0 = __umulhi(0xD2511F53u, counter[0]);
+		uint32_t	low0 = 0xD2511F53u * counter[0];
+		uint32_t	high1 = __umulhi(0xCD9E8D57u, counter[2]);
+		uint32_t	low1 = 0xCD9E8D57u * counter[2];
+
+		counter[0]	= high1 ^ counter[1] ^ k0;
+		counter[1]	= low1;
+		counter[2]	= high0 ^ counter[3] ^ k1;
+		counter[3]	= low0;
+		k0		+= 0x9E3779B9u;
+		k1		+= 0xBB67AE85u;
+	}
+
+	return (((uint64_t) counter[0] << 32 | counter[1]) >> 11) * 1.1102230246251565e-16;	/* 2^-53 */
+}
+
+/*
+ *	inverseNormal() of lift-monte-carlo.c: Acklam's approximation and one Halley step.
+ */
+static __device__ double
+deviceInverseNormal(double p)
+{
+	const double	a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+				1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+	const double	b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+				6.680131188771972e+01, -1.328068155288572e+01};
+	const double	c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+				-2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+	const double	d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+				3.754408661907416e+00};
+	double		q, r, x, e, u;
+
+	if (p < 0.02425 || p > 1.0 - 0.02425)
+	{
+		q = sqrt(-2.0 * log(p < 0.5 ? p : 1.0 - p));
+		x = (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+			((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1.0);
+		x = p < 0.5 ? x : -x;
+	}
+	else
+	{
+		q = p - 0.5;
+		r = q * q;
+		x = (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q /
+			(((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1.0);
+	}
+	e = 0.5 * erfc(-x / sqrt(2.0)) - p;
+	u = e * sqrt(2.0 * 3.141592653589793) * exp(x * x / 2.0);
+
+	return x - u / (1.0 + x * u / 2.0);
+}
+
+/*
+ *	One sample of the model: its draws in order, one coordinate each, then the lift or the density.
+ */
+static __device__ double
+sampleValue(uint64_t sample)
+{
+	const MonteCarloModel *	model = &deviceRun.model;
+	double			inputs[modelInputCount] = {model->point.V, model->point.h, model->point.T,
+					model->point.Rh, model->point.A};
+	double			under = model->factors.under;
+	double			over = model->factors.over;
+
+	for (uint32_t dimension = 0; dimension < model->drawCount; dimension++)
+	{
+		const MonteCarloDraw *	draw = &model->draws[dimension];
+		double			u = deviceUniform(dimension, sample);
+		size_t			index;
+
+		switch (draw->kind)
+		{
+		case MonteCarloDrawUniform:
+			inputs[draw->input] = draw->parameters[0] + (draw->parameters[1] - draw->parameters[0]) * u;
+			break;
+		case MonteCarloDrawGauss:
+			inputs[draw->input] = draw->parameters[0] +
+					sqrt(draw->parameters[1]) * deviceInverseNormal(u > 0.0 ? u : 5.551115123125783e-17);
+			break;
+		default:
+			index	= (size_t) (u * model->factorSampleCount);
+			index	= index < model->factorSampleCount ? index : model->factorSampleCount - 1;
+			over	= model->factorSamples[index][0];
+			under	= model->factorSamples[index][1];
+			break;
+		}
+	}
+	if (model->density)
+	{
+		return deviceAirDensity(inputs[ModelInputH], inputs[ModelInputT], inputs[ModelInputRh]);
+	}
+
+	return deviceLift(inputs[ModelInputV], inputs[ModelInputH], inputs[ModelInputT], inputs[ModelInputRh],
+			inputs[ModelInputA], under, over);
+}
+
+static __host__ __device__ void
+momentsMerge(GpuMoments * into, const GpuMoments * from)
+{
+	uint64_t	count = into->count + from->count;
+	double		delta = from->mean - into->mean;
+
+	if (from->count == 0)
+	{
+		return;
+	}
+	into->mean	+= delta * from->count / count;
+	into->m2	+= from->m2 + delta * delta * ((double) into->count * from->count / count);
+	into->count	= count;
+	into->min	= from->min < into->min ? from->min : into->min;
+	into->max	= from->max > into->max ? from->max : into->max;
+	into->zeroCount	+= from->zeroCount;
+}
+
+/*
+ *	Samples first .. first+count-1, grid-stride: each block writes the moments of its samples to
+ *	partials[blockIdx.x] and adds their buckets to `positive` and `negative`, as streamingSummaryAdd().
+ */
+static __global__ void
+monteCarloKernel(uint64_t first, uint64_t count, GpuMoments * partials, unsigned long long * positive,
+		unsigned long long * negative)
+{
+	__shared__ GpuMoments	shared[gpuThreadsPerBlock];
+	GpuMoments		local = {0, 0.0, 0.0, HUGE_VAL, -HUGE_VAL, 0};
+
+	for (uint64_t i = blockIdx.x * (uint64_t) blockDim.x + threadIdx.x; i < count;
+		i += (uint64_t) gridDim.x * blockDim.x)
+	{
+		double	value = sampleValue(first + i);
+		double	magnitude = fabs(value);
+		double	delta = value - local.mean;
+
+		local.count++;
+		local.mean	+= delta / local.count;
+		local.m2	+= delta * (value - local.mean);
+		local.min	= value < local.min ? value : local.min;
+		local.max	= value > local.max ? value : local.max;
+		if (!(magnitude >= summaryMinMagnitude))
+		{
+			local.zeroCount++;
+		}
+		else
+		{
+			double	index = ceil(log(magnitude / summaryMinMagnitude) * deviceRun.inverseLogGamma);
+			size_t	bucket = index < summaryBucketCount ? (size_t) index : summaryBucketCount - 1;
+
+			atomicAdd(&(value > 0.0 ? positive : negative)[bucket], 1ull);
+		}
+	}
+
+	shared[threadIdx.x] = local;
+	__syncthreads();
+	for (unsigned int width = blockDim.x / 2; width > 0; width /= 2)
+	{
+		if (threadIdx.x < width)
+		{
+			momentsMerge(&shared[threadIdx.x], &shared[threadIdx.x + width]);
+		}
+		__syncthreads();
+	}
+	if (threadIdx.x == 0)
+	{
+		partials[blockIdx.x] = shared[0];
+	}
+}
+
+typedef struct
+{
+	cudaStream_t	stream;
+	GpuMoments *	device;
+	GpuMoments *	host;		/* pinned */
+	int		blocks;		/* of the launch in flight; 0: idle */
+} GpuMonteCarloStream;
+
+/*
+ *	Wait for the launch in flight on `stream`, if any, and merge its per-block moments into `moments`.
+ */
+static int
+retireLaunch(GpuMonteCarloStream * stream, GpuMoments * moments)
+{
+	if (stream->blocks == 0)
+	{
+		return 0;
+	}
+	if (cudaStreamSynchronize(stream->stream) != cudaSuccess)
+	{
+		return -1;
+	}
+	for (int b = 0; b < stream->blocks; b++)
+	{
+		momentsMerge(moments, &stream->host[b]);
+	}
+	stream->blocks = 0;
+
+	return 0;
+}
+
+/*
+ *	monteCarloRun() of `model` on the device, with the random sampler, into `summary`. Returns 0, or -1
+ *	if there is no device or it fails.
+ */
+int
+gpuMonteCarloRun(const MonteCarloOptions * options, const MonteCarloModel * model, StreamingSummary * summary)
+{
+	const int		maxBlocks = (gpuMonteCarloLaunch + gpuThreadsPerBlock * gpuSamplesPerThread - 1) /
+					(gpuThreadsPerBlock * gpuSamplesPerThread);
+	GpuMonteCarloStream	streams[gpuStreamCount];
+	GpuMonteCarloRun	run;
+	GpuMoments		moments = {0, 0.0, 0.0, HUGE_VAL, -HUGE_VAL, 0};
+	StreamingSummary	device;
+	unsigned long long *	buckets = NULL;
+	double (*		factorSamples)[2] = NULL;
+	int			count = 0;
+	int			status = 0;
+	uint64_t		launch = 0;
+
+	memset(streams, 0, sizeof(streams));
+	if (cudaGetDeviceCount(&count) != cudaSuccess || count == 0 || cudaSetDevice(0) != cudaSuccess ||
+		streamingSummaryInit(&device) != 0)
+	{
+		return -1;
+	}
+
+	memset(&run, 0, sizeof(run));
+	run.model		= *model;
+	run.key[0]		= (uint32_t) options->seed;
+	run.key[1]		= (uint32_t) (options->seed >> 32);
+	run.inverseLogGamma	= device.inverseLogGamma;
+	if (model->factorSampleCount > 0)
+	{
+		size_t	size = model->factorSampleCount * sizeof(double[2]);
+
+		status = cudaMalloc((void **) &factorSamples, size) != cudaSuccess ||
+			cudaMemcpy(factorSamples, model->factorSamples, size, cudaMemcpyHostToDevice) != cudaSuccess ? -1 : 0;
+		run.model.factorSamples = factorSamples;
+	}
+	if (status == 0 && (cudaMemcpyToSymbol(deviceRun, &run, sizeof(run)) != cudaSuccess ||
+		cudaMalloc((void **) &buckets, 2 * summaryBucketCount * sizeof(unsigned long long)) != cudaSuccess ||
+		cudaMemset(buckets, 0, 2 * summaryBucketCount * sizeof(unsigned long long)) != cudaSuccess))
+	{
+		status = -1;
+	}
+	for (int s = 0; status == 0 && s < gpuStreamCount; s++)
+	{
+		if (cudaStreamCreateWithFlags(&streams[s].stream, cudaStreamNonBlocking) != cudaSuccess ||
+			cudaMalloc((void **) &streams[s].device, maxBlocks * sizeof(GpuMoments)) != cudaSuccess ||
+			cudaMallocHost((void **) &streams[s].host, maxBlocks * sizeof(GpuMoments)) != cudaSuccess)
+		{
+			status = -1;
+		}
+	}
+
+	/*
+	 *	Launches alternate between the streams; retiring a stream before reusing it merges the launches
+	 *	in the order they were made.
+	 */
+	for (uint64_t first = 0; status == 0 && first < options->samples; first += gpuMonteCarloLaunch, launch++)
+	{
+		GpuMonteCarloStream *	stream = &streams[launch % gpuStreamCount];
+		uint64_t		samples = options->samples - first < (uint64_t) gpuMonteCarloLaunch ?
+						options->samples - first : (uint64_t) gpuMonteCarloLaunch;
+		int			blocks = (int) ((samples + gpuThreadsPerBlock * gpuSamplesPerThread - 1) /
+						(gpuThreadsPerBlock * gpuSamplesPerThread));
+
+		if (retireLaunch(stream, &moments) != 0)
+		{
+			status = -1;
+			break;
+		}
+		monteCarloKernel<<<blocks, gpuThreadsPerBlock, 0, stream->stream>>>(first, samples, stream->device,
+				buckets, buckets + summaryBucketCount);
+		if (cudaGetLastError() != cudaSuccess ||
+			cudaMemcpyAsync(stream->host, stream->device, blocks * sizeof(GpuMoments), cudaMemcpyDeviceToHost,
+				stream->stream) != cudaSuccess)
+		{
+			status = -1;
+			break;
+		}
+		stream->blocks = blocks;
+	}
+	for (uint64_t s = launch; s < launch + gpuStreamCount; s++)
+	{
+		if (retireLaunch(&streams[s % gpuStreamCount], &moments) != 0)
+		{
+			status = -1;
+		}
+	}
+
+	/*
+	 *	The device's buckets and moments make one more partial summary for the caller's.
+	 */
+	if (status == 0 &&
+		(cudaMemcpy(device.positive, buckets, summaryBucketCount * sizeof(uint64_t), cudaMemcpyDeviceToHost) != cudaSuccess ||
+		cudaMemcpy(device.negative, buckets + summaryBucketCount, summaryBucketCount * sizeof(uint64_t),
+			cudaMemcpyDeviceToHost) != cudaSuccess))
+	{
+		status = -1;
+	}
+	if (status == 0)
+	{
+		device.count		= moments.count;
+		device.mean		= moments.mean;
+		device.m2		= moments.m2;
+		device.min		= moments.min;
+		device.max		= moments.max;
+		device.zeroCount	= moments.zeroCount;
+		streamingSummaryMerge(summary, &device);
+	}
+
+	for (int s = 0; s < gpuStreamCount; s++)
+	{
+		if (streams[s].stream != NULL)
+		{
+			cudaStreamDestroy(streams[s].stream);
+		}
+		cudaFree(streams[s].device);
+		cudaFreeHost(streams[s].host);
+	}
+	cudaFree(buckets);
+	cudaFree(factorSamples);
+	streamingSummaryFree(&device);
+
+	return status;
+}
+#endif
+#endif
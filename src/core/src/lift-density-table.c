@@ -0,0 +1,140 @@
+#include <math.h>
+#include <stdlib.h>
+#include "lift-core.h"
+
+/*
+ *	Density lookup table over the troposphere grid of the model inputs.
+ *
+ *	airDensity() is linear in Rh: r = Pair/(Rd*Tk) + Rh * Psat*(1/Rv - 1/Rd)/Tk. The table therefore stores
+ *	the dry term on an (h, T) grid and the vapour term on a T grid, and interpolates them bilinearly and
+ *	linearly; this is what trilinear interpolation over (h, T, Rh) gives, without a grid axis for Rh and
+ *	without any interpolation error in Rh. Points outside the grid fall back to airDensity().
+ */
+static const double	densityTableHMin	= 0.0;
+static const double	densityTableHMax	= 11019.2;
+static const double	densityTableTMin	= -50.0;
+static const double	densityTableTMax	= 50.0;
+
+/*
+ *	Largest relative error against airDensity(), at the centres of the grid cells (where bilinear
+ *	interpolation of the convex dry term is furthest off) for dry and saturated air.
+ */
+static double
+measureError(const DensityTable * table)
+{
+	double	maxError = 0.0;
+
+	for (size_t j = 0; j + 1 < table->TCount; j++)
+	{
+		for (size_t i = 0; i + 1 < table->hCount; i++)
+		{
+			double	h = table->hMin + (i + 0.5) / table->hScale;
+			double	T = table->TMin + (j + 0.5) / table->TScale;
+
+			for (double Rh = 0.0; Rh <= 1.0; Rh += 1.0)
+			{
+				double	exact = airDensity(h, T, Rh);
+				double	error = fabs(densityTableLookup(table, h, T, Rh) - exact) / exact;
+
+				maxError = error > maxError ? error : maxError;
+			}
+		}
+	}
+
+	return maxError;
+}
+
+/*
+ *	Build a table of hCount x TCount nodes (at least 2 x 2) spanning 0..11019.2 m and -50..50 °C.
+ */
+int
+densityTableInit(DensityTable * table, size_t hCount, size_t TCount)
+{
+	if (hCount < 2 || TCount < 2)
+	{
+		return -1;
+	}
+
+	table->hCount	= hCount;
+	table->TCount	= TCount;
+	table->hMin	= densityTableHMin;
+	table->hMax	= densityTableHMax;
+	table->TMin	= densityTableTMin;
+	table->TMax	= densityTableTMax;
+	table->hScale	= (hCount - 1) / (table->hMax - table->hMin);
+	table->TScale	= (TCount - 1) / (table->TMax - table->TMin);
+	table->dry	= liftMalloc(hCount * TCount * sizeof(double));
+	table->vapour	= liftMalloc(TCount * sizeof(double));
+	if (table->dry == NULL || table->vapour == NULL)
+	{
+		densityTableFree(table);
+		return -1;
+	}
+
+	for (size_t j = 0; j < TCount; j++)
+	{
+		double	T = j + 1 == TCount ? table->TMax : table->TMin + j / table->TScale;
+
+		for (size_t i = 0; i < hCount; i++)
+		{
+			double	h = i + 1 == hCount ? table->hMax : table->hMin + i / table->hScale;
+
+			table->dry[j * hCount + i] = airDensity(h, T, 0.0);
+		}
+		table->vapour[j] = airDensity(0.0, T, 1.0) - airDensity(0.0, T, 0.0);
+	}
+	table->maxError = measureError(table);
+
+	return 0;
+}
+
+void
+densityTableFree(DensityTable * table)
+{
+	liftFree(table->dry);
+	liftFree(table->vapour);
+	table->dry	= NULL;
+	table->vapour	= NULL;
+}
+
+double
+densityTableLookup(const DensityTable * table, double h, double T, double Rh)
+{
+	double		u, w, fh, fT, dry;
+	size_t		i, j;
+	const double *	row;
+
+	if (!(h >= table->hMin && h <= table->hMax && T >= table->TMin && T <= table->TMax))
+	{
+		return airDensity(h, T, Rh);
+	}
+
+	u	= (h - table->hMin) * table->hScale;
+	w	= (T - table->TMin) * table->TScale;
+	i	= (size_t) u < table->hCount - 2 ? (size_t) u : table->hCount - 2;
+	j	= (size_t) w < table->TCount - 2 ? (size_t) w : table->TCount - 2;
+	fh	= u - i;
+	fT	= w - j;
+	row	= &table->dry[j * table->hCount + i];
+	dry	= (1.0 - fT) * ((1.0 - fh) * row[0] + fh * row[1]) +
+			fT * ((1.0 - fh) * row[table->hCount] + fh * row[table->hCount + 1]);
+
+	return dry + Rh * ((1.0 - fT) * table->vapour[j] + fT * table->vapour[j + 1]);
+}
+
+/*
+ *	lift[i] as liftKernel() computes it, with the density taken from the table.
+ */
+void
+densityTableKernel(const DensityTable * table, size_t count, const double * V, const double * h,
+		const double * T, const double * Rh, const double * A, const VelocityFactors * factors, double * lift)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		double	r	= densityTableLookup(table, h[i], T[i], Rh[i]);
+		double	v1	= V[i] * factors->under;
+		double	v2	= V[i] * factors->over;
+
+		lift[i] = r*A[i]*(v2*v2-v1*v1) / 2.0;
+	}
+}
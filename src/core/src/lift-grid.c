@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Sweep grid specification: `axis=value` or `axis=low:high:count` items separated by `,`, with axis
+ *	one of V, h, T, Rh, A and AoA, e.g. `V=10:50:41,h=0:11000:12,AoA=0:10:11`. Axes that are not given
+ *	hold the default operating point; without AoA, the angle is not swept and the sweep uses the velocity
+ *	factors it would use anyway. `count` values run from `low` to `high` inclusive. An axis may be given
+ *	only once.
+ */
+static const char *	gridAxisNames[gridAxisCount] = {
+	[GridAxisV]	= "V",
+	[GridAxisH]	= "h",
+	[GridAxisT]	= "T",
+	[GridAxisRh]	= "Rh",
+	[GridAxisA]	= "A",
+	[GridAxisAngle]	= "AoA",
+};
+
+/*
+ *	Parse `value` or `low:high:count`. Returns 0, or -1 on malformed input.
+ */
+static int
+parseGridRange(const char * text, GridRange * range)
+{
+	char *	end;
+
+	range->low	= strtod(text, &end);
+	range->high	= range->low;
+	range->count	= 1;
+	if (end == text)
+	{
+		return -1;
+	}
+	if (*end != ':')
+	{
+		return *end == '\0' || *end == ',' ? 0 : -1;
+	}
+	text = end + 1;
+	range->high = strtod(text, &end);
+	if (end == text || *end != ':' || end[1] < '0' || end[1] > '9')
+	{
+		return -1;
+	}
+	text = end + 1;
+	range->count = strtoull(text, &end, 10);
+
+	return range->count > 0 && (*end == '\0' || *end == ',') ? 0 : -1;
+}
+
+int
+parseSweepGrid(const char * specification, SweepGrid * grid)
+{
+	const double	defaults[] = {
+		[GridAxisV]	= defaultOperatingPoint.V,
+		[GridAxisH]	= defaultOperatingPoint.h,
+		[GridAxisT]	= defaultOperatingPoint.T,
+		[GridAxisRh]	= defaultOperatingPoint.Rh,
+		[GridAxisA]	= defaultOperatingPoint.A,
+		[GridAxisAngle]	= 0.0,
+	};
+	const char *	cursor = specification;
+	int		given[gridAxisCount] = {0};
+
+	for (int a = 0; a < gridAxisCount; a++)
+	{
+		grid->axes[a].low	= defaults[a];
+		grid->axes[a].high	= defaults[a];
+		grid->axes[a].count	= a == GridAxisAngle ? 0 : 1;
+	}
+
+	while (*cursor != '\0')
+	{
+		size_t	length = strcspn(cursor, "=,");
+		int	axis = -1;
+
+		for (int a = 0; a < gridAxisCount; a++)
+		{
+			if (strlen(gridAxisNames[a]) == length && strncmp(cursor, gridAxisNames[a], length) == 0)
+			{
+				axis = a;
+			}
+		}
+		if (axis < 0 || given[axis] || cursor[length] != '=' ||
+			parseGridRange(cursor + length + 1, &grid->axes[axis]) != 0)
+		{
+			return -1;
+		}
+		given[axis] = 1;
+		cursor += length + 1 + strcspn(cursor + length + 1, ",");
+		cursor += *cursor == ',';
+	}
+
+	grid->pointCount = 1;
+	for (int a = 0; a < gridAxisCount; a++)
+	{
+		uint64_t	count = grid->axes[a].count > 0 ? grid->axes[a].count : 1;
+
+		if (count > UINT64_MAX / grid->pointCount)
+		{
+			return -1;
+		}
+		grid->pointCount *= count;
+	}
+
+	return 0;
+}
+
+/*
+ *	Parse `i/n`, shard i (from 0) of n. Returns 0, or -1 on malformed input.
+ */
+int
+parseShard(const char * specification, uint64_t * shard, uint64_t * shardCount)
+{
+	char *	end;
+
+	if (specification[0] < '0' || specification[0] > '9')
+	{
+		return -1;
+	}
+	*shard = strtoull(specification, &end, 10);
+	if (*end != '/' || end[1] < '0' || end[1] > '9')
+	{
+		return -1;
+	}
+	*shardCount = strtoull(end + 1, &end, 10);
+
+	return *end == '\0' && *shard < *shardCount ? 0 : -1;
+}
+
+double
+sweepGridValue(const GridRange * range, uint64_t index)
+{
+	if (range->count <= 1)
+	{
+		return range->low;
+	}
+
+	return index == range->count - 1 ? range->high :
+			range->low + (range->high - range->low) * (double) index / (double) (range->count - 1);
+}
+
+/*
+ *	Points begin .. end-1 of shard `shard` of `shardCount`: the first pointCount % shardCount shards
+ *	have one point more than the others.
+ */
+void
+sweepGridShard(const SweepGrid * grid, uint64_t shard, uint64_t shardCount, uint64_t * begin, uint64_t * end)
+{
+	uint64_t	size = grid->pointCount / shardCount;
+	uint64_t	remainder = grid->pointCount % shardCount;
+
+	*begin	= shard * size + (shard < remainder ? shard : remainder);
+	*end	= *begin + size + (shard < remainder);
+}
+
+/*
+ *	Operating point number `index` of the grid, and the index of its angle of attack.
+ */
+void
+sweepGridPoint(const SweepGrid * grid, uint64_t index, OperatingPoint * point, size_t * angle)
+{
+	double	values[gridAxisCount];
+
+	for (int a = GridAxisA; a >= 0; a--)
+	{
+		uint64_t	count = grid->axes[a].count;
+
+		values[a]	= sweepGridValue(&grid->axes[a], index % count);
+		index		/= count;
+	}
+	point->V	= values[GridAxisV];
+	point->h	= values[GridAxisH];
+	point->T	= values[GridAxisT];
+	point->Rh	= values[GridAxisRh];
+	point->A	= values[GridAxisA];
+	*angle		= (size_t) index;
+}
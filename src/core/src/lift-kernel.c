@@ -0,0 +1,331 @@
+#include <stdint.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Batch kernel over structure-of-arrays operating points.
+ *
+ *	exp() and 10^x on the density path are replaced by a Cody-Waite range reduction followed by a
+ *	degree-12 Taylor polynomial, which stays within a couple of ulp of libm over the model's input range.
+ *	The kernel is written once against a handful of primitive operations: vector* for the widest
+ *	instruction set the compiler targets (AVX-512, AVX2 or NEON) and scalar* as the width-1 fallback.
+ *	Both run the same sequence of IEEE operations, so every build (and the scalar tail of every batch)
+ *	gives bit-identical lift values. Floating-point contraction is disabled for the kernel because an FMA
+ *	in one path and not in the other would break that. Define LIFT_KERNEL_SCALAR to force the fallback.
+ */
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if !defined(LIFT_KERNEL_SCALAR) && defined(__AVX512F__)
+#include <immintrin.h>
+#define LIFT_VECTOR_WIDTH	8
+typedef __m512d		VectorDouble;
+#define vectorLoad(p)		_mm512_loadu_pd(p)
+#define vectorStore(p, x)	_mm512_storeu_pd((p), (x))
+#define vectorSet1(x)		_mm512_set1_pd(x)
+#define vectorAdd(a, b)		_mm512_add_pd((a), (b))
+#define vectorSub(a, b)		_mm512_sub_pd((a), (b))
+#define vectorMul(a, b)		_mm512_mul_pd((a), (b))
+#define vectorDiv(a, b)		_mm512_div_pd((a), (b))
+#define vectorMin(a, b)		_mm512_min_pd((a), (b))
+#define vectorMax(a, b)		_mm512_max_pd((a), (b))
+#define vectorExponentFromShifted(t)	_mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(_mm512_castpd_si512(t), _mm512_set1_epi64(1023)), 52))
+#elif !defined(LIFT_KERNEL_SCALAR) && defined(__AVX2__)
+#include <immintrin.h>
+#define LIFT_VECTOR_WIDTH	4
+typedef __m256d		VectorDouble;
+#define vectorLoad(p)		_mm256_loadu_pd(p)
+#define vectorStore(p, x)	_mm256_storeu_pd((p), (x))
+#define vectorSet1(x)		_mm256_set1_pd(x)
+#define vectorAdd(a, b)		_mm256_add_pd((a), (b))
+#define vectorSub(a, b)		_mm256_sub_pd((a), (b))
+#define vectorMul(a, b)		_mm256_mul_pd((a), (b))
+#define vectorDiv(a, b)		_mm256_div_pd((a), (b))
+#define vectorMin(a, b)		_mm256_min_pd((a), (b))
+#define vectorMax(a, b)		_mm256_max_pd((a), (b))
+#define vectorExponentFromShifted(t)	_mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(t), _mm256_set1_epi64x(1023)), 52))
+#elif !defined(LIFT_KERNEL_SCALAR) && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LIFT_VECTOR_WIDTH	2
+typedef float64x2_t	VectorDouble;
+#define vectorLoad(p)		vld1q_f64(p)
+#define vectorStore(p, x)	vst1q_f64((p), (x))
+#define vectorSet1(x)		vdupq_n_f64(x)
+#define vectorAdd(a, b)		vaddq_f64((a), (b))
+#define vectorSub(a, b)		vsubq_f64((a), (b))
+#define vectorMul(a, b)		vmulq_f64((a), (b))
+#define vectorDiv(a, b)		vdivq_f64((a), (b))
+#define vectorMin(a, b)		vbslq_f64(vcltq_f64((a), (b)), (a), (b))
+#define vectorMax(a, b)		vbslq_f64(vcgtq_f64((a), (b)), (a), (b))
+#define vectorExponentFromShifted(t)	vreinterpretq_f64_s64(vshlq_n_s64(vaddq_s64(vreinterpretq_s64_f64(t), vdupq_n_s64(1023)), 52))
+#else
+#define LIFT_VECTOR_WIDTH	1
+#endif
+
+/*
+ *	The same primitives in single precision, with twice the lanes, for liftKernelSingle().
+ */
+#if !defined(LIFT_KERNEL_SCALAR) && defined(__AVX512F__)
+#define LIFT_SINGLE_WIDTH	16
+typedef __m512		VectorSingle;
+#define vectorSingleLoad(p)		_mm512_loadu_ps(p)
+#define vectorSingleStore(p, x)		_mm512_storeu_ps((p), (x))
+#define vectorSingleSet1(x)		_mm512_set1_ps(x)
+#define vectorSingleAdd(a, b)		_mm512_add_ps((a), (b))
+#define vectorSingleSub(a, b)		_mm512_sub_ps((a), (b))
+#define vectorSingleMul(a, b)		_mm512_mul_ps((a), (b))
+#define vectorSingleDiv(a, b)		_mm512_div_ps((a), (b))
+#define vectorSingleMin(a, b)		_mm512_min_ps((a), (b))
+#define vectorSingleMax(a, b)		_mm512_max_ps((a), (b))
+#define vectorSingleExponentFromShifted(t)	_mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_castps_si512(t), _mm512_set1_epi32(127)), 23))
+#elif !defined(LIFT_KERNEL_SCALAR) && defined(__AVX2__)
+#define LIFT_SINGLE_WIDTH	8
+typedef __m256		VectorSingle;
+#define vectorSingleLoad(p)		_mm256_loadu_ps(p)
+#define vectorSingleStore(p, x)		_mm256_storeu_ps((p), (x))
+#define vectorSingleSet1(x)		_mm256_set1_ps(x)
+#define vectorSingleAdd(a, b)		_mm256_add_ps((a), (b))
+#define vectorSingleSub(a, b)		_mm256_sub_ps((a), (b))
+#define vectorSingleMul(a, b)		_mm256_mul_ps((a), (b))
+#define vectorSingleDiv(a, b)		_mm256_div_ps((a), (b))
+#define vectorSingleMin(a, b)		_mm256_min_ps((a), (b))
+#define vectorSingleMax(a, b)		_mm256_max_ps((a), (b))
+#define vectorSingleExponentFromShifted(t)	_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_castps_si256(t), _mm256_set1_epi32(127)), 23))
+#elif !defined(LIFT_KERNEL_SCALAR) && defined(__ARM_NEON) && defined(__aarch64__)
+#define LIFT_SINGLE_WIDTH	4
+typedef float32x4_t	VectorSingle;
+#define vectorSingleLoad(p)		vld1q_f32(p)
+#define vectorSingleStore(p, x)		vst1q_f32((p), (x))
+#define vectorSingleSet1(x)		vdupq_n_f32(x)
+#define vectorSingleAdd(a, b)		vaddq_f32((a), (b))
+#define vectorSingleSub(a, b)		vsubq_f32((a), (b))
+#define vectorSingleMul(a, b)		vmulq_f32((a), (b))
+#define vectorSingleDiv(a, b)		vdivq_f32((a), (b))
+#define vectorSingleMin(a, b)		vbslq_f32(vcltq_f32((a), (b)), (a), (b))
+#define vectorSingleMax(a, b)		vbslq_f32(vcgtq_f32((a), (b)), (a), (b))
+#define vectorSingleExponentFromShifted(t)	vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vreinterpretq_s32_f32(t), vdupq_n_s32(127)), 23))
+#elif !defined(LIFT_KERNEL_SCALAR) && defined(__SSE2__)
+#include <immintrin.h>
+#define LIFT_SINGLE_WIDTH	4
+typedef __m128		VectorSingle;
+#define vectorSingleLoad(p)		_mm_loadu_ps(p)
+#define vectorSingleStore(p, x)		_mm_storeu_ps((p), (x))
+#define vectorSingleSet1(x)		_mm_set1_ps(x)
+#define vectorSingleAdd(a, b)		_mm_add_ps((a), (b))
+#define vectorSingleSub(a, b)		_mm_sub_ps((a), (b))
+#define vectorSingleMul(a, b)		_mm_mul_ps((a), (b))
+#define vectorSingleDiv(a, b)		_mm_div_ps((a), (b))
+#define vectorSingleMin(a, b)		_mm_min_ps((a), (b))
+#define vectorSingleMax(a, b)		_mm_max_ps((a), (b))
+#define vectorSingleExponentFromShifted(t)	_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_castps_si128(t), _mm_set1_epi32(127)), 23))
+#else
+#define LIFT_SINGLE_WIDTH	1
+#endif
+
+/*
+ *	Min/max follow the x86 minpd/maxpd convention (second operand when the comparison fails) so that the
+ *	scalar path matches the vector paths operation for operation.
+ */
+static inline double	scalarSet1(double x)			{ return x; }
+static inline double	scalarAdd(double a, double b)		{ return a + b; }
+static inline double	scalarSub(double a, double b)		{ return a - b; }
+static inline double	scalarMul(double a, double b)		{ return a * b; }
+static inline double	scalarDiv(double a, double b)		{ return a / b; }
+static inline double	scalarMin(double a, double b)		{ return a < b ? a : b; }
+static inline double	scalarMax(double a, double b)		{ return a > b ? a : b; }
+
+static inline double
+scalarExponentFromShifted(double t)
+{
+	uint64_t	bits;
+
+	memcpy(&bits, &t, sizeof(bits));
+	bits = (bits + 1023) << 52;
+	memcpy(&t, &bits, sizeof(bits));
+
+	return t;
+}
+
+static inline float	scalarSingleSet1(float x)		{ return x; }
+static inline float	scalarSingleAdd(float a, float b)	{ return a + b; }
+static inline float	scalarSingleSub(float a, float b)	{ return a - b; }
+static inline float	scalarSingleMul(float a, float b)	{ return a * b; }
+static inline float	scalarSingleDiv(float a, float b)	{ return a / b; }
+static inline float	scalarSingleMin(float a, float b)	{ return a < b ? a : b; }
+static inline float	scalarSingleMax(float a, float b)	{ return a > b ? a : b; }
+
+static inline float
+scalarSingleExponentFromShifted(float t)
+{
+	uint32_t	bits;
+
+	memcpy(&bits, &t, sizeof(bits));
+	bits = (bits + 127) << 23;
+	memcpy(&t, &bits, sizeof(bits));
+
+	return t;
+}
+
+/*
+ *	Adding 1.5*2^52 rounds x*log2(e) to the nearest integer n and leaves n in the low mantissa bits, from
+ *	which 2^n is assembled directly. ln(2) is split so that n*ln2High is exact for |n| < 2^21.
+ */
+static const double	expRoundingShift	= 6755399441055744.0;
+static const double	expLog2e		= 1.4426950408889634;
+static const double	expLn2High		= 6.93147180369123816490e-01;
+static const double	expLn2Low		= 1.90821492927058770002e-10;
+static const double	expLn10			= 2.302585092994046;
+static const double	expCoefficients[]	= {
+	1.0/479001600.0, 1.0/39916800.0, 1.0/3628800.0, 1.0/362880.0, 1.0/40320.0, 1.0/5040.0, 1.0/720.0,
+	1.0/120.0, 1.0/24.0, 1.0/6.0, 1.0/2.0, 1.0, 1.0
+};
+
+#define LIFT_DEFINE_EXP(name, Type, op)								\
+static inline Type										\
+name(Type x)											\
+{												\
+	Type	t, n, r, p;									\
+												\
+	x = op##Min(op##Max(x, op##Set1(-708.0)), op##Set1(708.0));				\
+	t = op##Add(op##Mul(x, op##Set1(expLog2e)), op##Set1(expRoundingShift));		\
+	n = op##Sub(t, op##Set1(expRoundingShift));						\
+	r = op##Sub(x, op##Mul(n, op##Set1(expLn2High)));					\
+	r = op##Sub(r, op##Mul(n, op##Set1(expLn2Low)));					\
+												\
+	p = op##Set1(expCoefficients[0]);							\
+	for (size_t i = 1; i < sizeof(expCoefficients)/sizeof(double); i++)			\
+	{											\
+		p = op##Add(op##Mul(p, r), op##Set1(expCoefficients[i]));			\
+	}											\
+												\
+	return op##Mul(p, op##ExponentFromShifted(t));						\
+}
+
+/*
+ *	Single precision: 1.5*2^23 rounds to the nearest integer, n*ln2High is exact for |n| < 2^11, and a
+ *	degree-7 Taylor polynomial is below half an ulp of float on |r| <= ln(2)/2.
+ */
+static const float	expSingleRoundingShift	= 12582912.0f;
+static const float	expSingleLn2High	= 0.693145751953125f;
+static const float	expSingleLn2Low		= 1.428606765330187045e-06f;
+static const float	expSingleCoefficients[]	= {
+	1.0f/5040.0f, 1.0f/720.0f, 1.0f/120.0f, 1.0f/24.0f, 1.0f/6.0f, 1.0f/2.0f, 1.0f, 1.0f
+};
+
+#define LIFT_DEFINE_EXP_SINGLE(name, Type, op)							\
+static inline Type										\
+name(Type x)											\
+{												\
+	Type	t, n, r, p;									\
+												\
+	x = op##Min(op##Max(x, op##Set1(-87.0f)), op##Set1(87.0f));				\
+	t = op##Add(op##Mul(x, op##Set1((float) expLog2e)), op##Set1(expSingleRoundingShift));	\
+	n = op##Sub(t, op##Set1(expSingleRoundingShift));					\
+	r = op##Sub(x, op##Mul(n, op##Set1(expSingleLn2High)));					\
+	r = op##Sub(r, op##Mul(n, op##Set1(expSingleLn2Low)));					\
+												\
+	p = op##Set1(expSingleCoefficients[0]);							\
+	for (size_t i = 1; i < sizeof(expSingleCoefficients)/sizeof(float); i++)		\
+	{											\
+		p = op##Add(op##Mul(p, r), op##Set1(expSingleCoefficients[i]));			\
+	}											\
+												\
+	return op##Mul(p, op##ExponentFromShifted(t));						\
+}
+
+/*
+ *	Same density chain and lift formula as airDensity()/computeLift(), with 10^x evaluated as exp(x*ln(10)).
+ */
+#define LIFT_DEFINE_LIFT(name, Type, op, expName)						\
+static inline Type										\
+name(Type V, Type h, Type T, Type Rh, Type A, Type under, Type over)				\
+{												\
+	Type	Tk	= op##Add(T, op##Set1(273.15));						\
+	Type	Pair	= op##Mul(expName(op##Div(op##Mul(op##Set1(-9.81 * 0.0289644), h),		\
+					op##Mul(op##Set1(8.31432), Tk))), op##Set1(101325.0));	\
+	Type	Psat	= op##Mul(op##Set1(6.1078), expName(op##Mul(op##Div(op##Mul(op##Set1(7.5), T),	\
+					op##Add(T, op##Set1(237.3))), op##Set1(expLn10))));	\
+	Type	Pv	= op##Mul(Psat, Rh);							\
+	Type	Pd	= op##Sub(Pair, Pv);							\
+	Type	r	= op##Add(op##Div(Pd, op##Mul(op##Set1(287.058), Tk)),			\
+					op##Div(Pv, op##Mul(op##Set1(461.495), Tk)));		\
+	Type	v1	= op##Mul(V, under);							\
+	Type	v2	= op##Mul(V, over);							\
+												\
+	return op##Div(op##Mul(op##Mul(r, A), op##Sub(op##Mul(v2, v2), op##Mul(v1, v1))),	\
+			op##Set1(2.0));								\
+}
+
+LIFT_DEFINE_EXP(scalarExp, double, scalar)
+LIFT_DEFINE_LIFT(scalarLift, double, scalar, scalarExp)
+#if LIFT_VECTOR_WIDTH > 1
+LIFT_DEFINE_EXP(vectorExp, VectorDouble, vector)
+LIFT_DEFINE_LIFT(vectorLift, VectorDouble, vector, vectorExp)
+#endif
+LIFT_DEFINE_EXP_SINGLE(scalarSingleExp, float, scalarSingle)
+LIFT_DEFINE_LIFT(scalarSingleLift, float, scalarSingle, scalarSingleExp)
+#if LIFT_SINGLE_WIDTH > 1
+LIFT_DEFINE_EXP_SINGLE(vectorSingleExp, VectorSingle, vectorSingle)
+LIFT_DEFINE_LIFT(vectorSingleLift, VectorSingle, vectorSingle, vectorSingleExp)
+#endif
+
+/*
+ *	lift[i] = Fl(V[i], h[i], T[i], Rh[i], A[i]) for i < count.
+ */
+void
+liftKernel(size_t count, const double * V, const double * h, const double * T, const double * Rh,
+		const double * A, const VelocityFactors * factors, double * lift)
+{
+	size_t	i = 0;
+
+#if LIFT_VECTOR_WIDTH > 1
+	VectorDouble	under	= vectorSet1(factors->under);
+	VectorDouble	over	= vectorSet1(factors->over);
+
+	for (; i + LIFT_VECTOR_WIDTH <= count; i += LIFT_VECTOR_WIDTH)
+	{
+		vectorStore(&lift[i], vectorLift(vectorLoad(&V[i]), vectorLoad(&h[i]), vectorLoad(&T[i]),
+				vectorLoad(&Rh[i]), vectorLoad(&A[i]), under, over));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		lift[i] = scalarLift(V[i], h[i], T[i], Rh[i], A[i], factors->under, factors->over);
+	}
+}
+
+/*
+ *	Single-precision liftKernel(), for screening sweeps: twice the lanes per instruction (four on x86
+ *	without AVX, where liftKernel() is scalar) and half the bytes per point. The velocity factors are
+ *	rounded to float once. Against liftKernel(), the relative error of the lift stays below
+ *	liftKernelSingleMaxError over the troposphere (see lift-core.h).
+ */
+void
+liftKernelSingle(size_t count, const float * V, const float * h, const float * T, const float * Rh,
+		const float * A, const VelocityFactors * factors, float * lift)
+{
+	size_t	i = 0;
+	float	under = (float) factors->under;
+	float	over = (float) factors->over;
+
+#if LIFT_SINGLE_WIDTH > 1
+	for (; i + LIFT_SINGLE_WIDTH <= count; i += LIFT_SINGLE_WIDTH)
+	{
+		vectorSingleStore(&lift[i], vectorSingleLift(vectorSingleLoad(&V[i]), vectorSingleLoad(&h[i]),
+				vectorSingleLoad(&T[i]), vectorSingleLoad(&Rh[i]), vectorSingleLoad(&A[i]),
+				vectorSingleSet1(under), vectorSingleSet1(over)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		lift[i] = scalarSingleLift(V[i], h[i], T[i], Rh[i], A[i], under, over);
+	}
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,465 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+static const struct
+{
+	const char *	name;
+	int		(*run)(const ModelOptions * options);
+} variants[] = {
+	[ModelVariantNoUncertainties]		= {"v1", runNoUncertainties},
+	[ModelVariantUncertainAtmosphere]	= {"v2", runUncertainAtmosphere},
+	[ModelVariantUncertainAngleOfAttack]	= {"v3", runUncertainAngleOfAttack},
+};
+
+static void
+printStatistics(const CpStatistics * statistics)
+{
+	printf("column;count;mean;stddev;min;max;mean sqrt(|1-Cp|);trapezoid sqrt(|1-Cp|);simpson sqrt(|1-Cp|)\n");
+	for (size_t j = 0; j < cpLayoutColumnCount(&statistics->layout); j++)
+	{
+		const CpColumnStatistics *	column = &statistics->columns[j];
+		char				name[cpTableNameLength];
+
+		cpLayoutColumnName(&statistics->layout, j, name);
+		printf("%s;%llu;%f;%f;%f;%f;%f;%f;%f\n", name, (unsigned long long) column->count, column->mean,
+			column->count > 1 ? sqrt(column->m2 / (column->count - 1)) : 0.0, column->min, column->max,
+			velocityIntegralFactor(&column->integral, IntegrationMean),
+			velocityIntegralFactor(&column->integral, IntegrationTrapezoid),
+			velocityIntegralFactor(&column->integral, IntegrationSimpson));
+	}
+}
+
+/*
+ *	--convert in.csv out.cpt: write a CSV Cp table in the binary format.
+ */
+static int
+convertCpTable(const char * input, const char * output)
+{
+	CpTable	table;
+	int	status;
+
+	if (cpTableReadCsv(input, &table) != 0)
+	{
+		printf("Could not read %s.\n", input);
+		exit(1);
+	}
+	status = cpTableWrite(&table, output);
+	cpTableFree(&table);
+	if (status != 0)
+	{
+		printf("Could not write %s.\n", output);
+		exit(1);
+	}
+
+	return 0;
+}
+
+/*
+ *	--statistics file.csv: per-column statistics and velocity factors of a CSV Cp table.
+ */
+static int
+printCpTableStatistics(const char * filename)
+{
+	CpStatistics	statistics;
+
+	if (cpStatisticsReadCsv(filename, &statistics) != 0)
+	{
+		printf("Could not read %s.\n", filename);
+		exit(1);
+	}
+	printStatistics(&statistics);
+	liftFree(statistics.columns);
+
+	return 0;
+}
+
+/*
+ *	--merge out in...: merge the result files of the shards of a grid into one, or their summary files
+ *	into one and print it.
+ */
+static int
+mergeShards(const char * output, const char * const * inputs, size_t count)
+{
+	StreamingSummary	merged;
+	int			status = resultFilesMerge(output, inputs, count);
+
+	if (status == 0)
+	{
+		return 0;
+	}
+	if (status < 0)
+	{
+		printf("Could not merge the result files into %s.\n", output);
+		exit(1);
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		StreamingSummary	summary;
+
+		if (streamingSummaryRead(inputs[i], i == 0 ? &merged : &summary) != 0)
+		{
+			printf("Could not read %s.\n", inputs[i]);
+			exit(1);
+		}
+		if (i > 0)
+		{
+			streamingSummaryMerge(&merged, &summary);
+			streamingSummaryFree(&summary);
+		}
+	}
+	if (streamingSummaryWrite(&merged, output) != 0)
+	{
+		printf("Could not write %s.\n", output);
+		exit(1);
+	}
+	printf("# %llu points: mean, stddev, min, 5%%, median, 95%%, max\n", (unsigned long long) merged.count);
+	printf("%f %f %f %f %f %f %f\n", merged.mean, streamingSummaryStddev(&merged), merged.min,
+		streamingSummaryQuantile(&merged, 0.05), streamingSummaryQuantile(&merged, 0.5),
+		streamingSummaryQuantile(&merged, 0.95), merged.max);
+	streamingSummaryFree(&merged);
+
+	return 0;
+}
+
+/*
+ *	Returns 1 if `argument` is a whole unsigned number, so that an optional count is not mistaken for a
+ *	file name.
+ */
+static int
+isCount(const char * argument)
+{
+	char *	end;
+
+	if (argument[0] < '0' || argument[0] > '9')
+	{
+		return 0;
+	}
+	strtoull(argument, &end, 10);
+
+	return *end == '\0';
+}
+
+/*
+ *	Density table resolution, `N` (N x N nodes) or `NxM` (N elevation by M temperature nodes).
+ */
+static int
+parseDensityNodes(const char * argument, size_t nodes[2])
+{
+	char *	end;
+
+	nodes[0] = nodes[1] = strtoul(argument, &end, 10);
+	if (*end == 'x')
+	{
+		nodes[1] = strtoul(end + 1, &end, 10);
+	}
+
+	return *end == '\0' && nodes[0] >= 2 && nodes[1] >= 2 ? 0 : -1;
+}
+
+static void
+printUsage(const char * program)
+{
+	fprintf(stderr, "Usage: %s [--variant v1|v2|v3] [--bench [iterations]] ...\n", program);
+	fprintf(stderr, "  v1: [--batch [file] [--output-format text|f64|f32] [--precision double|single]]\n"
+		"      [--gradient] [--threads N] [--schedule static|steal] [--density-table [N|NxM]]\n");
+	fprintf(stderr, "      [--grid V=lo:hi:n,h=...,T=...,Rh=...,A=...,AoA=... [--shard i/n] [--summary file.lsum]]\n");
+	fprintf(stderr, "      [--airfoils manifest --airfoil name [--reynolds Re] [--angle degrees] [--integration mode]]\n");
+	fprintf(stderr, "  v2: [--spec file [--scenario name]] [--batch [file]]\n");
+	fprintf(stderr, "  v3: [--serve] [--weights angle:weight,... [--interpolation linear|spline]]\n"
+		"      [--integration mean|trapezoid|simpson] [file]\n");
+	if (LIFT_MONTE_CARLO)
+	{
+		fprintf(stderr, "  v2, v3 (Monte Carlo backend): [--samples N] [--seed S] [--sampler random|halton|sobol|latin]\n"
+			"      [--threads N]\n");
+	}
+#if defined(LIFT_CUDA)
+	fprintf(stderr, "  --gpu: v1 --batch in double precision without --gradient or --density-table, and v2 and v3\n"
+		"      with the Monte Carlo backend's random sampler, on the CUDA device\n");
+#endif
+#if defined(LIFT_TRACE)
+	fprintf(stderr, "  --trace file [--trace-format json|trace-event]: stage timings and counters of the run\n");
+#endif
+	fprintf(stderr, "  %s --convert file.csv file.cpt | --statistics file.csv\n", program);
+	fprintf(stderr, "  %s --merge out.lres shard.lres... | --merge out.lsum shard.lsum...\n", program);
+}
+
+/*
+ *	Command line shared by the front-ends. `variant` runs unless --variant selects another one; options
+ *	that do not apply to the selected variant are rejected.
+ */
+int
+liftMain(int argc, char * argv[], ModelVariant variant)
+{
+	ModelOptions	options;
+	int		sampling = 0;
+	int		status;
+
+	memset(&options, 0, sizeof(options));
+	options.variant		= variant;
+	options.threadCount	= 1;
+	options.schedule	= SweepScheduleStatic;
+	options.integration	= IntegrationMean;
+	options.angleOfAttack	= 10.0;
+
+	if (argc == 4 && strcmp(argv[1], "--convert") == 0)
+	{
+		return convertCpTable(argv[2], argv[3]);
+	}
+	if (argc == 3 && strcmp(argv[1], "--statistics") == 0)
+	{
+		return printCpTableStatistics(argv[2]);
+	}
+	if (argc >= 4 && strcmp(argv[1], "--merge") == 0)
+	{
+		return mergeShards(argv[2], (const char * const *) &argv[3], (size_t) argc - 3);
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		int	known = 1;
+
+		if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc)
+		{
+			known = 0;
+			for (size_t v = 0; v < sizeof(variants)/sizeof(variants[0]); v++)
+			{
+				if (strcmp(argv[i + 1], variants[v].name) == 0)
+				{
+					options.variant	= (ModelVariant) v;
+					known		= 1;
+				}
+			}
+			i++;
+		}
+		else if (strcmp(argv[i], "--bench") == 0)
+		{
+			options.bench = 1;
+			if (i + 1 < argc && isCount(argv[i + 1]))
+			{
+				options.benchIterations = strtoull(argv[++i], NULL, 10);
+			}
+		}
+		else if (strcmp(argv[i], "--gradient") == 0)
+		{
+			options.gradient = 1;
+		}
+		else if (strcmp(argv[i], "--serve") == 0)
+		{
+			options.serve = 1;
+		}
+		else if (strcmp(argv[i], "--batch") == 0 || strcmp(argv[i], "-b") == 0)
+		{
+			options.batch = 1;
+			if (i + 1 < argc && (argv[i + 1][0] != '-' || strcmp(argv[i + 1], "-") == 0))
+			{
+				options.batchFile = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc)
+		{
+			known		= parseSweepGrid(argv[++i], &options.sweepGrid) == 0;
+			options.grid	= &options.sweepGrid;
+		}
+		else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc)
+		{
+			known = parseShard(argv[++i], &options.shard, &options.shardCount) == 0;
+		}
+		else if (strcmp(argv[i], "--summary") == 0 && i + 1 < argc)
+		{
+			options.summaryFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--output-format") == 0 && i + 1 < argc)
+		{
+			known = parseResultFormat(argv[++i], &options.resultFormat) == 0;
+		}
+#if defined(LIFT_CUDA)
+		else if (strcmp(argv[i], "--gpu") == 0)
+		{
+			options.gpu = 1;
+		}
+#endif
+#if defined(LIFT_TRACE)
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			options.traceFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--trace-format") == 0 && i + 1 < argc)
+		{
+			known = parseTraceFormat(argv[++i], &options.traceFormat) == 0;
+		}
+#endif
+		else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc && strcmp(argv[i + 1], "double") == 0)
+		{
+			options.precision = KernelPrecisionDouble;
+			i++;
+		}
+		else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc && strcmp(argv[i + 1], "single") == 0)
+		{
+			options.precision = KernelPrecisionSingle;
+			i++;
+		}
+		else if ((strcmp(argv[i], "--threads") == 0 || strcmp(argv[i], "-j") == 0) && i + 1 < argc)
+		{
+			options.threadCount = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--schedule") == 0 && i + 1 < argc && strcmp(argv[i + 1], "static") == 0)
+		{
+			options.schedule = SweepScheduleStatic;
+			i++;
+		}
+		else if (strcmp(argv[i], "--schedule") == 0 && i + 1 < argc && strcmp(argv[i + 1], "steal") == 0)
+		{
+			options.schedule = SweepScheduleSteal;
+			i++;
+		}
+		else if (strcmp(argv[i], "--density-table") == 0)
+		{
+			options.densityNodes[0] = options.densityNodes[1] = densityTableDefaultNodes;
+			if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9')
+			{
+				known = parseDensityNodes(argv[++i], options.densityNodes) == 0;
+			}
+		}
+		else if (strcmp(argv[i], "--airfoils") == 0 && i + 1 < argc)
+		{
+			options.airfoilManifest = argv[++i];
+		}
+		else if (strcmp(argv[i], "--airfoil") == 0 && i + 1 < argc)
+		{
+			options.airfoil = argv[++i];
+		}
+		else if (strcmp(argv[i], "--reynolds") == 0 && i + 1 < argc)
+		{
+			options.reynolds = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--angle") == 0 && i + 1 < argc)
+		{
+			options.angleOfAttack = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc && isCount(argv[i + 1]))
+		{
+			options.samples = strtoull(argv[++i], NULL, 10);
+			known = options.samples > 0;
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc && isCount(argv[i + 1]))
+		{
+			options.seed	= strtoull(argv[++i], NULL, 10);
+			sampling	= 1;
+		}
+#if LIFT_MONTE_CARLO
+		else if (strcmp(argv[i], "--sampler") == 0 && i + 1 < argc)
+		{
+			known		= monteCarloParseSampler(argv[++i], &options.sampler) == 0;
+			sampling	= 1;
+		}
+#endif
+		else if (strcmp(argv[i], "--spec") == 0 && i + 1 < argc)
+		{
+			options.specificationFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc)
+		{
+			options.scenario = argv[++i];
+		}
+		else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc)
+		{
+			if (parseAngleWeights(argv[++i], &options.angleWeights) != 0)
+			{
+				printf("Weights must be given as angle:weight,angle:weight,...\n");
+				exit(1);
+			}
+			options.weights = &options.angleWeights;
+		}
+		else if (strcmp(argv[i], "--interpolation") == 0 && i + 1 < argc && strcmp(argv[i + 1], "linear") == 0)
+		{
+			options.angleWeights.interpolation = AngleInterpolationLinear;
+			i++;
+		}
+		else if (strcmp(argv[i], "--interpolation") == 0 && i + 1 < argc && strcmp(argv[i + 1], "spline") == 0)
+		{
+			options.angleWeights.interpolation = AngleInterpolationSpline;
+			i++;
+		}
+		else if (strcmp(argv[i], "--integration") == 0 && i + 1 < argc && strcmp(argv[i + 1], "mean") == 0)
+		{
+			options.integration = IntegrationMean;
+			i++;
+		}
+		else if (strcmp(argv[i], "--integration") == 0 && i + 1 < argc && strcmp(argv[i + 1], "trapezoid") == 0)
+		{
+			options.integration = IntegrationTrapezoid;
+			i++;
+		}
+		else if (strcmp(argv[i], "--integration") == 0 && i + 1 < argc && strcmp(argv[i + 1], "simpson") == 0)
+		{
+			options.integration = IntegrationSimpson;
+			i++;
+		}
+		else if (argv[i][0] != '-' && options.tableFile == NULL)
+		{
+			options.tableFile = argv[i];
+		}
+		else
+		{
+			known = 0;
+		}
+
+		if (!known)
+		{
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if ((options.variant != ModelVariantNoUncertainties &&
+			((!LIFT_MONTE_CARLO && options.threadCount != 1) || options.schedule != SweepScheduleStatic ||
+			options.densityNodes[0] > 0)) ||
+		((!LIFT_MONTE_CARLO || options.variant == ModelVariantNoUncertainties) &&
+			(options.samples > 0 || sampling)) ||
+		(options.variant == ModelVariantUncertainAngleOfAttack && options.batch) ||
+		(options.variant != ModelVariantUncertainAngleOfAttack && options.serve) ||
+		(options.variant != ModelVariantUncertainAtmosphere &&
+			(options.specificationFile != NULL || options.scenario != NULL)) ||
+		(options.scenario != NULL && options.specificationFile == NULL) ||
+		(options.variant != ModelVariantNoUncertainties &&
+			(options.airfoilManifest != NULL || options.airfoil != NULL || options.gradient)) ||
+		(options.gradient && (options.threadCount != 1 || options.densityNodes[0] > 0)) ||
+		(options.grid != NULL && (options.variant != ModelVariantNoUncertainties || options.batch ||
+			options.gradient || options.bench)) ||
+		((options.shardCount > 0 || options.summaryFile != NULL) && options.grid == NULL) ||
+		(options.resultFormat != ResultFormatText && (options.variant != ModelVariantNoUncertainties ||
+			(!options.batch && options.grid == NULL) || options.gradient)) ||
+		(options.gpu && (options.bench || (options.variant == ModelVariantNoUncertainties ?
+			(!options.batch && options.grid == NULL) || options.gradient || options.densityNodes[0] > 0 ||
+			options.precision != KernelPrecisionDouble :
+			!LIFT_MONTE_CARLO || options.serve || options.sampler != MonteCarloSamplerRandom))) ||
+		(options.precision != KernelPrecisionDouble &&
+			(options.variant != ModelVariantNoUncertainties || (!options.batch && options.grid == NULL) ||
+			options.gradient || options.densityNodes[0] > 0)) ||
+		(options.traceFormat != TraceFormatJson && options.traceFile == NULL) ||
+		((options.airfoilManifest == NULL) != (options.airfoil == NULL)) ||
+		(options.angleWeights.interpolation != AngleInterpolationNone && options.weights == NULL) ||
+		(options.variant != ModelVariantUncertainAngleOfAttack &&
+			(options.tableFile != NULL || options.weights != NULL ||
+			(options.integration != IntegrationMean && options.airfoilManifest == NULL))))
+	{
+		fprintf(stderr, "These options do not apply to %s.\n", variants[options.variant].name);
+		printUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	status = variants[options.variant].run(&options);
+#if defined(LIFT_TRACE)
+	if (options.traceFile != NULL && traceWrite(options.traceFile, options.traceFormat) != 0)
+	{
+		fprintf(stderr, "Could not write %s.\n", options.traceFile);
+		status = EXIT_FAILURE;
+	}
+#endif
+
+	return status;
+}
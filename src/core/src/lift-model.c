@@ -0,0 +1,293 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+const OperatingPoint defaultOperatingPoint = {
+	.V	= 30.0,
+	.h	= 0.0,
+	.T	= 15.0,
+	.Rh	= 0.0,
+	.A	= 2.3E-1,
+};
+
+/*
+ *	Air pressure (Pa) at elevation h (m) and temperature T (°C), from the barometric formula.
+ */
+static double
+airPressure(double h, double T)
+{
+    return exp((-9.81 * 0.0289644 * h)/(8.31432 * (T+273.15))) * 101325.0; // atm * sea level pressure 101325 hPa
+}
+
+static double
+saturationVaporPressure(double T)
+{
+    return 6.1078*pow(10.0,7.5*T/(T+237.3));
+}
+
+/*
+ *	r = (Pd/(Rd*T))+(Pv/(Rv*T)), kg/m^3
+ */
+static double
+partialPressureDensity(double Pd, double Pv, double T)
+{
+    return (Pd/(287.058*(T+273.15)))+(Pv/(461.495*(T+273.15)));
+}
+
+/*
+ *	Density of humid air (kg/m^3) at elevation h (m), temperature T (°C) and relative humidity Rh.
+ */
+double
+airDensity(double h, double T, double Rh)
+{
+    //air pressure
+    double Pair = airPressure(h, T);
+    //saturation vapor pressure
+    double Psat = saturationVaporPressure(T);
+    //water vapor pressure
+    double Pv = Psat*Rh;
+    //pressure of dry air
+    double Pd = Pair - Pv;
+
+    return partialPressureDensity(Pd, Pv, T);
+}
+
+void
+loadInputs(const OperatingPoint * point, const VelocityFactors * factors, double *  A, double *  v1, double * v2, double * r)
+{
+    /*Vx = V * sqrt(|1-Cpx|), averaged over each surface*/
+	*v1 = point->V * factors->under;
+	*v2 = point->V * factors->over;
+	*A	= point->A;
+	*r	= airDensity(point->h, point->T, point->Rh);
+}
+
+double
+computeLift(const OperatingPoint * point, const VelocityFactors * factors)
+{
+	double	A, v1, v2, r;
+
+	loadInputs(point, factors, &A, &v1, &v2, &r);
+
+    /*	Fl = 1/2 * 𝜌 * a  * ((𝑣2)^2- (𝑣1)^2) */
+	return r*A*(v2*v2-v1*v1) / 2.0;
+}
+
+void
+computeLiftGradient(const OperatingPoint * point, const VelocityFactors * factors,
+		const VelocityFactors * factorSlopes, LiftGradient * gradient)
+{
+	double	Tk	= point->T+273.15;
+	double	Pair	= airPressure(point->h, point->T);
+	double	Psat	= saturationVaporPressure(point->T);
+	double	Pv	= Psat*point->Rh;
+	double	r	= partialPressureDensity(Pair - Pv, Pv, point->T);
+	double	v1	= point->V * factors->under;
+	double	v2	= point->V * factors->over;
+	double	q	= (v2*v2-v1*v1) / 2.0;
+
+	/*
+	 *	dPair/dh = -g M / (R Tk) Pair and dPair/dT = g M h / (R Tk^2) Pair; dPsat/dT = Psat ln(10) 7.5 *
+	 *	237.3 / (T+237.3)^2; r = Pair/(Rd Tk) + Pv (1/Rv - 1/Rd)/Tk, so dr/dTk also has the -r/Tk term.
+	 */
+	double	dPairdh		= -9.81 * 0.0289644 / (8.31432 * Tk) * Pair;
+	double	dPairdT		= 9.81 * 0.0289644 * point->h / (8.31432 * Tk * Tk) * Pair;
+	double	dPsatdT		= Psat * log(10.0) * 7.5 * 237.3 / ((point->T+237.3) * (point->T+237.3));
+	double	vapour		= (1.0/461.495 - 1.0/287.058) / Tk;
+	double	drdh		= dPairdh / (287.058*Tk);
+	double	drdT		= dPairdT / (287.058*Tk) + dPsatdT*point->Rh*vapour - r/Tk;
+	double	drdRh		= Psat*vapour;
+
+	gradient->lift	= r*point->A*q;
+	gradient->V	= r*point->A*(v2*factors->over-v1*factors->under);
+	gradient->A	= r*q;
+	gradient->h	= drdh*point->A*q;
+	gradient->T	= drdT*point->A*q;
+	gradient->Rh	= drdRh*point->A*q;
+	gradient->angle	= factorSlopes == NULL ? 0.0 :
+				r*point->A*point->V*(v2*factorSlopes->over-v1*factorSlopes->under);
+}
+
+void
+atmosphereContextInit(AtmosphereContext * atmosphere, double h, double T, double Rh)
+{
+	atmosphere->r = airDensity(h, T, Rh);
+}
+
+/*
+ *	Same lift as computeLift() at (V, h, T, Rh, A), for the atmosphere's h, T and Rh.
+ */
+double
+atmosphereLift(const AtmosphereContext * atmosphere, const VelocityFactors * factors, double V, double A)
+{
+	double	v1 = V * factors->under;
+	double	v2 = V * factors->over;
+
+	return atmosphere->r*A*(v2*v2-v1*v1) / 2.0;
+}
+
+void
+atmosphereLiftBatch(const AtmosphereContext * atmosphere, const VelocityFactors * factors, size_t count,
+		const double * V, const double * A, double * lift)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		lift[i] = atmosphereLift(atmosphere, factors, V[i], A[i]);
+	}
+}
+
+/*
+ *	Quantities that depend on each input.
+ */
+static const unsigned	inputDependents[modelInputCount] = {
+	[ModelInputV]	= IncrementalVelocities | IncrementalLift,
+	[ModelInputH]	= IncrementalPair | IncrementalPd | IncrementalDensity | IncrementalLift,
+	[ModelInputT]	= IncrementalPair | IncrementalPsat | IncrementalPv | IncrementalPd | IncrementalDensity | IncrementalLift,
+	[ModelInputRh]	= IncrementalPv | IncrementalPd | IncrementalDensity | IncrementalLift,
+	[ModelInputA]	= IncrementalLift,
+};
+
+void
+incrementalModelInit(IncrementalModel * model, const OperatingPoint * point, const VelocityFactors * factors)
+{
+	model->point	= *point;
+	model->factors	= *factors;
+	model->dirty	= IncrementalAll;
+}
+
+void
+incrementalModelSet(IncrementalModel * model, ModelInput input, double value)
+{
+	double *	inputs[modelInputCount] = {
+		[ModelInputV]	= &model->point.V,
+		[ModelInputH]	= &model->point.h,
+		[ModelInputT]	= &model->point.T,
+		[ModelInputRh]	= &model->point.Rh,
+		[ModelInputA]	= &model->point.A,
+	};
+
+	*inputs[input]	= value;
+	model->dirty	|= inputDependents[input];
+}
+
+void
+incrementalModelSetFactors(IncrementalModel * model, const VelocityFactors * factors)
+{
+	model->factors	= *factors;
+	model->dirty	|= IncrementalVelocities | IncrementalLift;
+}
+
+/*
+ *	Lift at the model's inputs, recomputing only the quantities invalidated since the last call.
+ */
+double
+incrementalModelLift(IncrementalModel * model)
+{
+	const OperatingPoint *	point = &model->point;
+	unsigned		dirty = model->dirty;
+
+	if (dirty & IncrementalPair)
+	{
+		model->Pair = airPressure(point->h, point->T);
+	}
+	if (dirty & IncrementalPsat)
+	{
+		model->Psat = saturationVaporPressure(point->T);
+	}
+	if (dirty & IncrementalPv)
+	{
+		model->Pv = model->Psat*point->Rh;
+	}
+	if (dirty & IncrementalPd)
+	{
+		model->Pd = model->Pair - model->Pv;
+	}
+	if (dirty & IncrementalDensity)
+	{
+		model->r = partialPressureDensity(model->Pd, model->Pv, point->T);
+	}
+	if (dirty & IncrementalVelocities)
+	{
+		model->v1 = point->V * model->factors.under;
+		model->v2 = point->V * model->factors.over;
+	}
+	if (dirty & IncrementalLift)
+	{
+		model->lift = model->r*point->A*(model->v2*model->v2-model->v1*model->v1) / 2.0;
+	}
+	model->dirty = 0;
+
+	return model->lift;
+}
+
+/*
+ *	Parse one `V h T Rh A` line. Returns 1 on success, 0 for blank/comment lines and -1 on malformed input,
+ *	including anything but whitespace or a `#` comment after the fifth value, so that a decimal comma
+ *	(`30,5 0 15 0 0,23`) is rejected instead of being read as six values.
+ */
+int
+parseOperatingPoint(const char * line, OperatingPoint * point)
+{
+	double		values[5];
+	const char *	cursor = line;
+
+	while (*cursor == ' ' || *cursor == '\t')
+	{
+		cursor++;
+	}
+	if (*cursor == '\0' || *cursor == '\n' || *cursor == '\r' || *cursor == '#')
+	{
+		return 0;
+	}
+
+	for (int i = 0; i < 5; i++)
+	{
+		char *	end;
+
+		while (*cursor == ' ' || *cursor == '\t' || *cursor == ',' || *cursor == ';')
+		{
+			cursor++;
+		}
+		values[i] = strtod(cursor, &end);
+		if (end == cursor)
+		{
+			return -1;
+		}
+		cursor = end;
+	}
+	while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n')
+	{
+		cursor++;
+	}
+	if (*cursor != '\0' && *cursor != '#')
+	{
+		return -1;
+	}
+
+	point->V	= values[0];
+	point->h	= values[1];
+	point->T	= values[2];
+	point->Rh	= values[3];
+	point->A	= values[4];
+
+	return 1;
+}
+
+/*
+ *	Returns 1 if fgets() filled `line` from `file` without reaching the end of the line, which goes on
+ *	in the file, and 0 if `line` holds a whole line (the last one of the file may have no '\n').
+ */
+int
+lineTruncated(const char * line, FILE * file)
+{
+	int	next;
+
+	if (strchr(line, '\n') != NULL || (next = getc(file)) == EOF)
+	{
+		return 0;
+	}
+	ungetc(next, file);
+
+	return 1;
+}
@@ -0,0 +1,511 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+#if LIFT_MONTE_CARLO
+/*
+ *	Native Monte Carlo backend for hosts without the uncertainty runtime.
+ *
+ *	The libUncertainDouble*() entry points return one sample of the requested distribution, and the code
+ *	that uses them runs once per Monte Carlo sample (monteCarloRun()). Each call consumes one coordinate
+ *	(the next "dimension") of the current sample's point in [0, 1)^d, which is a function of the seed, the
+ *	sample index and the dimension only. Results are therefore the same for any thread count and
+ *	schedule, and the sample range can be split across threads (or machines) freely.
+ *
+ *	The points come from the selected sampler:
+ *	-	random:	Philox4x32-10, a counter-based generator keyed by the seed and counted by (dimension,
+ *			sample)
+ *	-	halton:	the Halton sequence (radical inverse of the sample index in the dimension's prime base),
+ *			randomly shifted modulo 1 per dimension
+ *	-	sobol:	the Sobol sequence (Joe and Kuo's direction numbers), with a random digital shift per
+ *			dimension
+ *	-	latin:	Latin hypercube: in each dimension, the samples fall one per stratum of width 1/samples,
+ *			in a pseudorandom order (a keyed permutation of the sample indices) and at a random
+ *			position within their stratum
+ *	The low-discrepancy sequences cover the first monteCarloSequenceDimensions dimensions; later ones
+ *	fall back to random sampling.
+ */
+enum
+{
+	monteCarloSequenceDimensions	= 16,
+	feistelRounds			= 4,
+};
+
+typedef struct
+{
+	uint64_t	sample;
+	uint32_t	dimension;
+} MonteCarloStream;
+
+static MonteCarloSampler		monteCarloSampler;
+static uint32_t				monteCarloKey[2];
+static uint64_t				monteCarloSampleCount;
+static int				latinHalfBits;
+static double				haltonShifts[monteCarloSequenceDimensions];
+static uint32_t				sobolShifts[monteCarloSequenceDimensions];
+static uint32_t				sobolDirections[monteCarloSequenceDimensions][32];
+static _Thread_local MonteCarloStream	stream;
+
+/*
+ *	Primitive polynomials (degree, coefficients) and initial direction numbers of Sobol dimensions 2 to
+ *	16, from Joe and Kuo's new-joe-kuo-6.21201; dimension 1 is the van der Corput sequence.
+ */
+static const struct
+{
+	int		degree;
+	uint32_t	coefficients;
+	uint32_t	initial[6];
+} sobolPolynomials[monteCarloSequenceDimensions - 1] = {
+	{1,	0,	{1}},
+	{2,	1,	{1, 3}},
+	{3,	1,	{1, 3, 1}},
+	{3,	2,	{1, 1, 1}},
+	{4,	1,	{1, 1, 3, 3}},
+	{4,	4,	{1, 3, 5, 13}},
+	{5,	2,	{1, 1, 5, 5, 17}},
+	{5,	4,	{1, 1, 5, 5, 5}},
+	{5,	7,	{1, 1, 7, 11, 19}},
+	{5,	11,	{1, 1, 5, 1, 1}},
+	{5,	13,	{1, 1, 1, 3, 11}},
+	{5,	14,	{1, 3, 5, 5, 31}},
+	{6,	1,	{1, 3, 3, 9, 7, 49}},
+	{6,	13,	{1, 1, 1, 15, 21, 21}},
+	{6,	16,	{1, 3, 1, 13, 27, 49}},
+};
+
+static const uint32_t	haltonBases[monteCarloSequenceDimensions] = {
+	2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+};
+
+static void
+philox4x32(uint32_t counter[4], const uint32_t key[2])
+{
+	uint32_t	k0 = key[0];
+	uint32_t	k1 = key[1];
+
+	for (int round = 0; round < 10; round++)
+	{
+		uint64_t	product0 = (uint64_t) 0xD2511F53u * counter[0];
+		uint64_t	product1 = (uint64_t) 0xCD9E8D57u * counter[2];
+		uint32_t	c1 = counter[1];
+		uint32_t	c3 = counter[3];
+
+		counter[0]	= (uint32_t) (product1 >> 32) ^ c1 ^ k0;
+		counter[1]	= (uint32_t) product1;
+		counter[2]	= (uint32_t) (product0 >> 32) ^ c3 ^ k1;
+		counter[3]	= (uint32_t) product0;
+		k0		+= 0x9E3779B9u;
+		k1		+= 0xBB67AE85u;
+	}
+}
+
+/*
+ *	64 random bits for (dimension, stream, index): stream 0 draws the random sampler's coordinates and
+ *	the Latin hypercube jitter, stream 1 the per-dimension shifts and permutation keys.
+ */
+static uint64_t
+randomBits(uint32_t dimension, uint32_t streamIndex, uint64_t index)
+{
+	uint32_t	counter[4] = {dimension, streamIndex, (uint32_t) index, (uint32_t) (index >> 32)};
+
+	philox4x32(counter, monteCarloKey);
+
+	return (uint64_t) counter[0] << 32 | counter[1];
+}
+
+/*
+ *	Uniform on [0, 1) with 53 random bits.
+ */
+static double
+unitUniform(uint64_t bits)
+{
+	return (bits >> 11) * 0x1.0p-53;
+}
+
+static double
+radicalInverse(uint64_t index, uint32_t base)
+{
+	double	inverseBase = 1.0 / base;
+	double	scale = inverseBase;
+	double	value = 0.0;
+
+	for (; index > 0; index /= base)
+	{
+		value	+= (index % base) * scale;
+		scale	*= inverseBase;
+	}
+
+	return value;
+}
+
+static uint32_t
+sobolPoint(uint64_t index, uint32_t dimension)
+{
+	uint32_t	point = 0;
+
+	for (int bit = 0; index > 0 && bit < 32; bit++, index >>= 1)
+	{
+		if (index & 1)
+		{
+			point ^= sobolDirections[dimension][bit];
+		}
+	}
+
+	return point;
+}
+
+static void
+sobolInit(void)
+{
+	for (int bit = 0; bit < 32; bit++)
+	{
+		sobolDirections[0][bit] = 1u << (31 - bit);
+	}
+	for (int d = 1; d < monteCarloSequenceDimensions; d++)
+	{
+		int		degree = sobolPolynomials[d - 1].degree;
+		uint32_t	coefficients = sobolPolynomials[d - 1].coefficients;
+		uint32_t *	directions = sobolDirections[d];
+
+		for (int bit = 0; bit < degree; bit++)
+		{
+			directions[bit] = sobolPolynomials[d - 1].initial[bit] << (31 - bit);
+		}
+		for (int bit = degree; bit < 32; bit++)
+		{
+			directions[bit] = directions[bit - degree] ^ (directions[bit - degree] >> degree);
+			for (int k = 1; k < degree; k++)
+			{
+				if ((coefficients >> (degree - 1 - k)) & 1)
+				{
+					directions[bit] ^= directions[bit - k];
+				}
+			}
+		}
+	}
+}
+
+/*
+ *	Position of `index` in a keyed permutation of [0, samples): a Feistel network over the smallest
+ *	power of 4 that holds `samples`, walked until the result falls in range.
+ */
+static uint64_t
+latinStratum(uint64_t index, uint32_t dimension)
+{
+	uint64_t	mask = ((uint64_t) 1 << latinHalfBits) - 1;
+
+	do
+	{
+		uint64_t	left = index >> latinHalfBits;
+		uint64_t	right = index & mask;
+
+		for (int round = 0; round < feistelRounds; round++)
+		{
+			uint64_t	mixed = left ^ (randomBits(dimension, 1, (uint64_t) round << 32 | right) & mask);
+
+			left	= right;
+			right	= mixed;
+		}
+		index = left << latinHalfBits | right;
+	} while (index >= monteCarloSampleCount);
+
+	return index;
+}
+
+/*
+ *	Next coordinate of the current sample's point.
+ */
+static double
+nextUniform(void)
+{
+	uint32_t	dimension = stream.dimension++;
+	uint64_t	sample = stream.sample;
+	double		value;
+
+	if (dimension >= monteCarloSequenceDimensions && monteCarloSampler != MonteCarloSamplerLatin)
+	{
+		return unitUniform(randomBits(dimension, 0, sample));
+	}
+	switch (monteCarloSampler)
+	{
+	case MonteCarloSamplerHalton:
+		value = radicalInverse(sample, haltonBases[dimension]) + haltonShifts[dimension];
+		return value < 1.0 ? value : value - 1.0;
+	case MonteCarloSamplerSobol:
+		return (sobolPoint(sample, dimension) ^ sobolShifts[dimension]) * 0x1.0p-32;
+	case MonteCarloSamplerLatin:
+		value = (latinStratum(sample, dimension) + unitUniform(randomBits(dimension, 0, sample))) /
+				monteCarloSampleCount;
+		return value < 1.0 ? value : 0x1.fffffffffffffp-1;
+	default:
+		return unitUniform(randomBits(dimension, 0, sample));
+	}
+}
+
+/*
+ *	Inverse of the standard normal distribution function: Acklam's rational approximation, refined by
+ *	one Halley step against erfc() to full double precision.
+ */
+static double
+inverseNormal(double p)
+{
+	static const double	a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+					1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+	static const double	b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+					6.680131188771972e+01, -1.328068155288572e+01};
+	static const double	c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+					-2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+	static const double	d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+					3.754408661907416e+00};
+	double			q, r, x, e, u;
+
+	if (p < 0.02425 || p > 1.0 - 0.02425)
+	{
+		q = sqrt(-2.0 * log(p < 0.5 ? p : 1.0 - p));
+		x = (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+			((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1.0);
+		x = p < 0.5 ? x : -x;
+	}
+	else
+	{
+		q = p - 0.5;
+		r = q * q;
+		x = (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q /
+			(((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1.0);
+	}
+	e = 0.5 * erfc(-x / sqrt(2.0)) - p;
+	u = e * sqrt(2.0 * 3.141592653589793) * exp(x * x / 2.0);
+
+	return x - u / (1.0 + x * u / 2.0);
+}
+
+static size_t
+sampleIndex(size_t count)
+{
+	size_t	index = (size_t) (nextUniform() * count);
+
+	return index < count ? index : count - 1;
+}
+
+void
+monteCarloSelectSample(uint64_t sample)
+{
+	stream.sample		= sample;
+	stream.dimension	= 0;
+}
+
+double
+libUncertainDoubleUniformDist(double min, double max)
+{
+	return min + (max - min) * nextUniform();
+}
+
+/*
+ *	By inversion, so that every Gaussian input takes one coordinate; the coordinate is moved off 0 so
+ *	that the result is finite.
+ */
+double
+libUncertainDoubleGaussDist(double mean, double variance)
+{
+	double	u = nextUniform();
+
+	return mean + sqrt(variance) * inverseNormal(u > 0.0 ? u : 0x1.0p-54);
+}
+
+double
+libUncertainDoubleDistFromSamples(double * samples, size_t sampleCount)
+{
+	return samples[sampleIndex(sampleCount)];
+}
+
+void
+libUncertainDoubleDistFromMultidimensionalSamples(double * destination, void * samples, size_t sampleCount,
+		size_t dimensions)
+{
+	const double *	sample = (const double *) samples + sampleIndex(sampleCount) * dimensions;
+
+	memcpy(destination, sample, dimensions * sizeof(double));
+}
+
+/*
+ *	Sampler named `name`. Returns 0, or -1 if there is none.
+ */
+int
+monteCarloParseSampler(const char * name, MonteCarloSampler * sampler)
+{
+	static const char *	names[] = {
+		[MonteCarloSamplerRandom]	= "random",
+		[MonteCarloSamplerHalton]	= "halton",
+		[MonteCarloSamplerSobol]	= "sobol",
+		[MonteCarloSamplerLatin]	= "latin",
+	};
+
+	for (size_t s = 0; s < sizeof(names)/sizeof(names[0]); s++)
+	{
+		if (strcmp(name, names[s]) == 0)
+		{
+			*sampler = (MonteCarloSampler) s;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ *	Seed-dependent state shared by every thread of a run.
+ */
+static void
+samplerInit(const MonteCarloOptions * options)
+{
+	monteCarloSampler	= options->sampler;
+	monteCarloKey[0]	= (uint32_t) options->seed;
+	monteCarloKey[1]	= (uint32_t) (options->seed >> 32);
+	monteCarloSampleCount	= options->samples;
+	for (latinHalfBits = 1; ((uint64_t) 1 << (2 * latinHalfBits)) < options->samples; latinHalfBits++)
+	{
+	}
+	for (int d = 0; d < monteCarloSequenceDimensions; d++)
+	{
+		uint64_t	bits = randomBits(d, 1, (uint64_t) feistelRounds << 32);
+
+		haltonShifts[d]	= unitUniform(bits);
+		sobolShifts[d]	= (uint32_t) (bits >> 32);
+	}
+	if (options->sampler == MonteCarloSamplerSobol)
+	{
+		sobolInit();
+	}
+}
+
+typedef struct
+{
+	MonteCarloEvaluate	evaluate;
+	void *			context;
+	StreamingSummary *	summaries;	/* one per worker */
+} MonteCarloJob;
+
+static void
+evaluateSampleRange(void * context, int worker, size_t begin, size_t end)
+{
+	MonteCarloJob *	job = context;
+	double		values[sweepChunkSize];
+
+	LIFT_TRACE_BEGIN(range, TraceStageSamples);
+	job->evaluate(job->context, begin, end - begin, values);
+	streamingSummaryAddValues(&job->summaries[worker], values, end - begin);
+	LIFT_TRACE_END(range);
+	LIFT_TRACE_COUNT(TraceCounterSamples, end - begin);
+}
+
+/*
+ *	Add evaluate() of every sample to `summary`, with the samples spread over the threads. Each thread
+ *	summarises its own samples, a chunk at a time, and the partial summaries are merged at the end, so
+ *	no sample is stored. The evaluations of a range call monteCarloSelectSample() before drawing each
+ *	sample's inputs. With options->gpu, the run goes to the device instead (LIFT_CUDA builds).
+ */
+int
+monteCarloRun(const MonteCarloOptions * options, MonteCarloEvaluate evaluate, void * context,
+		StreamingSummary * summary)
+{
+	SweepPool	pool;
+	MonteCarloJob	job = {
+		.evaluate	= evaluate,
+		.context	= context,
+	};
+	SweepJob	sweep = {
+		.count		= options->samples,
+		.evaluate	= evaluateSampleRange,
+		.context	= &job,
+	};
+	int		initialised = 0;
+	int		status = 0;
+
+#if defined(LIFT_CUDA)
+	if (options->gpu != NULL)
+	{
+		return gpuMonteCarloRun(options, options->gpu, summary);
+	}
+#endif
+	if (sweepPoolInit(&pool, options->threadCount, SweepScheduleSteal) != 0)
+	{
+		return -1;
+	}
+	job.summaries = liftCalloc(pool.threadCount, sizeof(StreamingSummary));
+	status = job.summaries == NULL ? -1 : 0;
+	for (; status == 0 && initialised < pool.threadCount; initialised++)
+	{
+		status = streamingSummaryInit(&job.summaries[initialised]);
+	}
+	if (status == 0)
+	{
+		samplerInit(options);
+		runSweep(&pool, &sweep);
+	}
+	for (int t = 0; t < initialised; t++)
+	{
+		if (status == 0)
+		{
+			streamingSummaryMerge(summary, &job.summaries[t]);
+		}
+		streamingSummaryFree(&job.summaries[t]);
+	}
+	liftFree(job.summaries);
+	sweepPoolDestroy(&pool);
+
+	return status;
+}
+
+/*
+ *	Mean, standard deviation, extremes and 5%, 50% and 95% quantiles of `streaming`.
+ */
+void
+monteCarloSummarize(const StreamingSummary * streaming, MonteCarloSummary * summary)
+{
+	summary->count		= streaming->count;
+	summary->mean		= streaming->mean;
+	summary->stddev		= streamingSummaryStddev(streaming);
+	summary->min		= streaming->count > 0 ? streaming->min : 0.0;
+	summary->max		= streaming->count > 0 ? streaming->max : 0.0;
+	summary->quantiles[0]	= streamingSummaryQuantile(streaming, 0.05);
+	summary->quantiles[1]	= streamingSummaryQuantile(streaming, 0.50);
+	summary->quantiles[2]	= streamingSummaryQuantile(streaming, 0.95);
+}
+
+/*
+ *	monteCarloRun() into a streaming summary, and monteCarloSummarize() of it.
+ */
+int
+monteCarloEstimate(const MonteCarloOptions * options, MonteCarloEvaluate evaluate, void * context,
+		MonteCarloSummary * summary)
+{
+	StreamingSummary	streaming;
+	int			status;
+
+	if (options->samples == 0 || streamingSummaryInit(&streaming) != 0)
+	{
+		return -1;
+	}
+	LIFT_TRACE_BEGIN(run, TraceStageMonteCarlo);
+	status = monteCarloRun(options, evaluate, context, &streaming);
+	LIFT_TRACE_END(run);
+	if (status != 0)
+	{
+		streamingSummaryFree(&streaming);
+		return -1;
+	}
+	monteCarloSummarize(&streaming, summary);
+	streamingSummaryFree(&streaming);
+
+	return 0;
+}
+
+void
+monteCarloPrintSummary(FILE * output, const MonteCarloSummary * summary)
+{
+	fprintf(output, "# Monte Carlo, %llu samples: mean %f, stddev %f, min %f, 5%% %f, median %f, 95%% %f, max %f\n",
+		(unsigned long long) summary->count, summary->mean, summary->stddev, summary->min,
+		summary->quantiles[0], summary->quantiles[1], summary->quantiles[2], summary->max);
+}
+#endif
@@ -0,0 +1,417 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+#if !defined(LIFT_NO_WRITEV)
+#include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+/*
+ *	Batch results, as text (one `%f` line per point) or as a binary columnar stream (.lres), in host
+ *	byte order:
+ *	-	ResultFileHeader, resultAlignment bytes
+ *	-	blocks of at most batchBlockSize points, each
+ *		-	ResultBlockHeader, resultAlignment bytes
+ *		-	the index column: count uint64, the input point index (0 for the first point) of each
+ *			lift, zero padded to a multiple of resultAlignment
+ *		-	the lift column: count float64 or float32, zero padded the same way
+ *	-	a ResultBlockHeader with count 0 that ends the stream
+ *	Every column starts on a resultAlignment boundary with nothing but its values, which is Arrow's
+ *	buffer layout for non-nullable uint64 and float columns, so a mapped file's blocks can be used as
+ *	record batches in place. Each block goes out in one writev(2) call.
+ */
+typedef struct
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrder;
+	uint32_t	valueSize;	/* bytes per lift value: 8 or 4 */
+	uint32_t	columns;	/* 2: index and lift */
+	char		reserved[resultAlignment - 24];
+} ResultFileHeader;
+
+typedef struct
+{
+	uint64_t	count;		/* 0: end of the stream */
+	uint64_t	firstIndex;
+	uint64_t	valuesOffset;	/* of the lift column, from the start of this header */
+	uint64_t	nextOffset;	/* of the next block header, from the start of this header */
+	char		reserved[resultAlignment - 32];
+} ResultBlockHeader;
+
+static const char	resultMagic[8] = {'L', 'I', 'F', 'T', 'R', 'E', 'S', '\0'};
+static const char	resultPadding[resultAlignment];
+
+static size_t
+paddingAfter(size_t size)
+{
+	return (resultAlignment - size % resultAlignment) % resultAlignment;
+}
+
+/*
+ *	Write `count` pieces of output in order, retrying writes that a signal interrupts. Returns 0, or -1 on
+ *	a write error.
+ */
+static int
+writePieces(FILE * output, const void * const * pieces, const size_t * sizes, int count)
+{
+#if !defined(LIFT_NO_WRITEV)
+	struct iovec	vector[8];
+	int		descriptor = fileno(output);
+	int		first = 0;
+
+	if (fflush(output) != 0)
+	{
+		return -1;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		vector[i].iov_base	= (void *) pieces[i];
+		vector[i].iov_len	= sizes[i];
+	}
+	while (first < count)
+	{
+		ssize_t	written = writev(descriptor, &vector[first], count - first);
+
+		if (written < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (written < 0)
+		{
+			return -1;
+		}
+		for (; first < count && (size_t) written >= vector[first].iov_len; first++)
+		{
+			written -= vector[first].iov_len;
+		}
+		if (first < count)
+		{
+			vector[first].iov_base	= (char *) vector[first].iov_base + written;
+			vector[first].iov_len	-= written;
+		}
+	}
+
+	return 0;
+#else
+	for (int i = 0; i < count; i++)
+	{
+		if (fwrite(pieces[i], 1, sizes[i], output) != sizes[i])
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+#endif
+}
+
+/*
+ *	Parse `text`, `f64` or `f32`. Returns 0, or -1 if `name` is none of them.
+ */
+int
+parseResultFormat(const char * name, ResultFormat * format)
+{
+	static const char *	names[] = {
+		[ResultFormatText]	= "text",
+		[ResultFormatFloat64]	= "f64",
+		[ResultFormatFloat32]	= "f32",
+	};
+
+	for (size_t f = 0; f < sizeof(names)/sizeof(names[0]); f++)
+	{
+		if (strcmp(name, names[f]) == 0)
+		{
+			*format = (ResultFormat) f;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+int
+resultWriterInit(ResultWriter * writer, FILE * output, ResultFormat format)
+{
+	ResultFileHeader	header;
+	const void *		pieces[] = {&header};
+	size_t			sizes[] = {sizeof(header)};
+
+	memset(writer, 0, sizeof(*writer));
+	writer->format	= format;
+	writer->output	= output;
+	if (format == ResultFormatText)
+	{
+		return 0;
+	}
+
+	writer->indices		= liftMalloc(batchBlockSize * sizeof(uint64_t));
+	writer->narrowed	= format == ResultFormatFloat32 ? liftMalloc(batchBlockSize * sizeof(float)) : NULL;
+	if (writer->indices == NULL || (format == ResultFormatFloat32 && writer->narrowed == NULL))
+	{
+		resultWriterFinish(writer);
+		return -1;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, resultMagic, sizeof(header.magic));
+	header.version		= resultFileVersion;
+	header.byteOrder	= cpTableByteOrder;
+	header.valueSize	= format == ResultFormatFloat32 ? sizeof(float) : sizeof(double);
+	header.columns		= 2;
+
+	return writePieces(output, pieces, sizes, 1);
+}
+
+/*
+ *	Write the lift of the next `count` points.
+ */
+int
+resultWriterWrite(ResultWriter * writer, const double * lift, size_t count)
+{
+	if (writer->format == ResultFormatText)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			fprintf(writer->output, "%f\n", lift[i]);
+		}
+		writer->written += count;
+		return ferror(writer->output) ? -1 : 0;
+	}
+
+	for (size_t begin = 0; begin < count; begin += batchBlockSize)
+	{
+		size_t			blockCount = count - begin < batchBlockSize ? count - begin : batchBlockSize;
+		size_t			valueSize = writer->format == ResultFormatFloat32 ? sizeof(float) : sizeof(double);
+		size_t			indexSize = blockCount * sizeof(uint64_t);
+		size_t			liftSize = blockCount * valueSize;
+		ResultBlockHeader	header;
+		const void *		pieces[5];
+		size_t			sizes[5];
+
+		for (size_t i = 0; i < blockCount; i++)
+		{
+			writer->indices[i] = writer->written + i;
+		}
+		if (writer->format == ResultFormatFloat32)
+		{
+			for (size_t i = 0; i < blockCount; i++)
+			{
+				writer->narrowed[i] = (float) lift[begin + i];
+			}
+		}
+
+		memset(&header, 0, sizeof(header));
+		header.count		= blockCount;
+		header.firstIndex	= writer->written;
+		header.valuesOffset	= sizeof(header) + indexSize + paddingAfter(indexSize);
+		header.nextOffset	= header.valuesOffset + liftSize + paddingAfter(liftSize);
+
+		pieces[0] = &header;		sizes[0] = sizeof(header);
+		pieces[1] = writer->indices;	sizes[1] = indexSize;
+		pieces[2] = resultPadding;	sizes[2] = paddingAfter(indexSize);
+		pieces[3] = writer->format == ResultFormatFloat32 ? (const void *) writer->narrowed :
+				(const void *) &lift[begin];
+		sizes[3] = liftSize;
+		pieces[4] = resultPadding;	sizes[4] = paddingAfter(liftSize);
+		if (writePieces(writer->output, pieces, sizes, 5) != 0)
+		{
+			return -1;
+		}
+		writer->written += blockCount;
+	}
+
+	return 0;
+}
+
+/*
+ *	End the stream and release the writer. Returns 0, or -1 on a write error.
+ */
+int
+resultWriterFinish(ResultWriter * writer)
+{
+	ResultBlockHeader	end;
+	const void *		pieces[] = {&end};
+	size_t			sizes[] = {sizeof(end)};
+	int			status = 0;
+
+	if (writer->format != ResultFormatText && writer->indices != NULL)
+	{
+		memset(&end, 0, sizeof(end));
+		end.firstIndex	= writer->written;
+		status		= writePieces(writer->output, pieces, sizes, 1);
+	}
+	liftFree(writer->indices);
+	liftFree(writer->narrowed);
+	writer->indices		= NULL;
+	writer->narrowed	= NULL;
+
+	return fflush(writer->output) == 0 ? status : -1;
+}
+
+/*
+ *	Merging result files: each input is a run of blocks over a contiguous index range, ended by a block
+ *	of count 0 whose firstIndex is the end of the range. The inputs are ordered by the start of their
+ *	ranges and their blocks copied as they are, so shards merge without being decoded, and merged files
+ *	merge again.
+ */
+typedef struct
+{
+	const char *		filename;
+	FILE *			file;
+	ResultFileHeader	header;
+	ResultBlockHeader	block;		/* the next one of the file */
+} ResultShard;
+
+static int
+compareShards(const void * a, const void * b)
+{
+	const ResultShard *	left = a;
+	const ResultShard *	right = b;
+
+	return (left->block.firstIndex > right->block.firstIndex) - (left->block.firstIndex < right->block.firstIndex);
+}
+
+/*
+ *	Read the next block header of `shard`, checking that its offsets are those of its count.
+ */
+static int
+readBlockHeader(ResultShard * shard)
+{
+	size_t	indexSize, liftSize;
+
+	if (fread(&shard->block, sizeof(shard->block), 1, shard->file) != 1 || shard->block.count > batchBlockSize)
+	{
+		return -1;
+	}
+	indexSize	= shard->block.count * sizeof(uint64_t);
+	liftSize	= shard->block.count * shard->header.valueSize;
+
+	return shard->block.count == 0 || (shard->block.valuesOffset == sizeof(shard->block) + indexSize +
+			paddingAfter(indexSize) && shard->block.nextOffset == shard->block.valuesOffset + liftSize +
+			paddingAfter(liftSize)) ? 0 : -1;
+}
+
+/*
+ *	Open a result file at its first block. Returns 1 if it is not a result file.
+ */
+static int
+openShard(const char * filename, ResultShard * shard)
+{
+	shard->filename	= filename;
+	shard->file	= fopen(filename, "rb");
+	if (shard->file == NULL)
+	{
+		return -1;
+	}
+	if (fread(&shard->header, sizeof(shard->header), 1, shard->file) != 1 ||
+		memcmp(shard->header.magic, resultMagic, sizeof(resultMagic)) != 0)
+	{
+		return 1;
+	}
+	if (shard->header.version != resultFileVersion || shard->header.byteOrder != cpTableByteOrder ||
+		shard->header.columns != 2 ||
+		(shard->header.valueSize != sizeof(double) && shard->header.valueSize != sizeof(float)))
+	{
+		return -1;
+	}
+
+	return readBlockHeader(shard);
+}
+
+int
+resultFilesMerge(const char * output, const char * const * inputs, size_t count)
+{
+	ResultShard *		shards = liftCalloc(count, sizeof(*shards));
+	ResultBlockHeader	end;
+	FILE *			file = NULL;
+	unsigned char *		payload = NULL;
+	size_t			capacity = 0;
+	uint64_t		expected;
+	int			status = shards != NULL && count > 0 ? 0 : -1;
+
+	for (size_t i = 0; status == 0 && i < count; i++)
+	{
+		status = openShard(inputs[i], &shards[i]);
+		if (status == 1 && i > 0)
+		{
+			fprintf(stderr, "%s is not a result file.\n", inputs[i]);
+			status = -1;
+		}
+		else if (status == 0 && shards[i].header.valueSize != shards[0].header.valueSize)
+		{
+			fprintf(stderr, "%s and %s hold lift values of different sizes.\n", inputs[0], inputs[i]);
+			status = -1;
+		}
+	}
+	if (status == 0)
+	{
+		qsort(shards, count, sizeof(*shards), compareShards);
+		file = fopen(output, "wb");
+		status = file != NULL && fwrite(&shards[0].header, sizeof(shards[0].header), 1, file) == 1 ? 0 : -1;
+	}
+
+	expected = status == 0 ? shards[0].block.firstIndex : 0;
+	for (size_t i = 0; status == 0 && i < count; i++)
+	{
+		ResultShard *	shard = &shards[i];
+
+		while (status == 0 && shard->block.count > 0)
+		{
+			size_t	size = shard->block.nextOffset - sizeof(shard->block);
+
+			if (shard->block.firstIndex != expected)
+			{
+				break;
+			}
+			if (size > capacity)
+			{
+				unsigned char *	grown = liftRealloc(payload, size);
+
+				if (grown == NULL)
+				{
+					status = -1;
+					break;
+				}
+				payload		= grown;
+				capacity	= size;
+			}
+			if (fread(payload, 1, size, shard->file) != size ||
+				fwrite(&shard->block, sizeof(shard->block), 1, file) != 1 || fwrite(payload, 1, size, file) != size)
+			{
+				status = -1;
+				break;
+			}
+			expected += shard->block.count;
+			status = readBlockHeader(shard);
+		}
+		if (status == 0 && shard->block.firstIndex != expected)
+		{
+			fprintf(stderr, "%s does not continue at point %llu.\n", shard->filename, (unsigned long long) expected);
+			status = -1;
+		}
+	}
+	if (status == 0)
+	{
+		memset(&end, 0, sizeof(end));
+		end.firstIndex	= expected;
+		status		= fwrite(&end, sizeof(end), 1, file) == 1 ? 0 : -1;
+	}
+
+	for (size_t i = 0; shards != NULL && i < count; i++)
+	{
+		if (shards[i].file != NULL)
+		{
+			fclose(shards[i].file);
+		}
+	}
+	if (file != NULL && fclose(file) != 0)
+	{
+		status = -1;
+	}
+	liftFree(shards);
+	liftFree(payload);
+
+	return status;
+}
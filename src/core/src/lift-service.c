@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	--serve: a long-running model that keeps its Cp table resident and answers queries read line by line
+ *	from `input`, one response line per request, flushed as soon as it is written:
+ *	-	`V h T Rh A`				`<lift>`
+ *	-	`weights angle:weight,...` or `weights all`	`ok`, after recomputing the velocity factors
+ *	-	`integration mean|trapezoid|simpson`	`ok`, after recomputing the velocity factors
+ *	-	`interpolation none|linear|spline`	`ok`, after recomputing the velocity factors (weighted angles
+ *							between the tabulated ones need linear or spline)
+ *	-	`quit`					ends the session, as does the end of `input`
+ *	Malformed requests are answered with `error <reason>` and the session goes on; so are requests longer
+ *	than the line buffer, whose rest is discarded so that they get a single response. Blank lines and
+ *	lines starting with `#` get no response.
+ *
+ *	The velocity factors are only recomputed when the weights or the integration mode change, in the
+ *	context's arena, so a lift query costs one line parse and one density chain and no request allocates
+ *	from the heap.
+ */
+static int
+hasCommand(const char * line, const char * command, const char ** argument)
+{
+	size_t	length = strlen(command);
+
+	if (strncmp(line, command, length) != 0 || (line[length] != ' ' && line[length] != '\t'))
+	{
+		return 0;
+	}
+	*argument = line + length + strspn(line + length, " \t");
+
+	return 1;
+}
+
+int
+runService(LiftContext * context, FILE * input, FILE * output)
+{
+	static const struct
+	{
+		const char *	name;
+		IntegrationMode	mode;
+	} modes[] = {
+		{"mean",	IntegrationMean},
+		{"trapezoid",	IntegrationTrapezoid},
+		{"simpson",	IntegrationSimpson},
+	};
+	static const struct
+	{
+		const char *		name;
+		AngleInterpolation	interpolation;
+	} interpolations[] = {
+		{"none",	AngleInterpolationNone},
+		{"linear",	AngleInterpolationLinear},
+		{"spline",	AngleInterpolationSpline},
+	};
+	AngleWeights	current = {.interpolation = AngleInterpolationNone};
+	char		line[4096];
+
+	if (context->weighted)
+	{
+		current = context->weights;
+	}
+
+	while (fgets(line, sizeof(line), input))
+	{
+		const char *	text = line + strspn(line, " \t");
+		const char *	argument;
+		OperatingPoint	point;
+		int		status;
+
+		if (lineTruncated(line, input))
+		{
+			int	c;
+
+			while ((c = getc(input)) != EOF && c != '\n')
+			{
+			}
+			fprintf(output, "error line too long\n");
+			fflush(output);
+			continue;
+		}
+		line[strcspn(line, "\r\n")] = '\0';
+		if (strcmp(text, "quit") == 0)
+		{
+			break;
+		}
+
+		if (hasCommand(text, "weights", &argument))
+		{
+			AngleWeights	requested = {.interpolation = current.interpolation};
+			int		all = strcmp(argument, "all") == 0;
+
+			if (!all && parseAngleWeights(argument, &requested) != 0)
+			{
+				fprintf(output, "error expected weights angle:weight,... or weights all\n");
+			}
+			else if (liftContextConfigure(context, context->mode, all ? NULL : &requested) != 0)
+			{
+				fprintf(output, "error no angle of attack has a positive weight, or one is outside the table\n");
+			}
+			else
+			{
+				if (!all)
+				{
+					current = requested;
+				}
+				fprintf(output, "ok\n");
+			}
+		}
+		else if (hasCommand(text, "integration", &argument))
+		{
+			size_t	m = 0;
+
+			while (m < sizeof(modes)/sizeof(modes[0]) && strcmp(argument, modes[m].name) != 0)
+			{
+				m++;
+			}
+			if (m == sizeof(modes)/sizeof(modes[0]))
+			{
+				fprintf(output, "error expected integration mean|trapezoid|simpson\n");
+			}
+			else if (liftContextConfigure(context, modes[m].mode, context->weighted ? &current : NULL) != 0)
+			{
+				fprintf(output, "error no angle of attack has a positive weight, or one is outside the table\n");
+			}
+			else
+			{
+				fprintf(output, "ok\n");
+			}
+		}
+		else if (hasCommand(text, "interpolation", &argument))
+		{
+			size_t		m = 0;
+			AngleWeights	requested = current;
+
+			while (m < sizeof(interpolations)/sizeof(interpolations[0]) &&
+				strcmp(argument, interpolations[m].name) != 0)
+			{
+				m++;
+			}
+			if (m == sizeof(interpolations)/sizeof(interpolations[0]))
+			{
+				fprintf(output, "error expected interpolation none|linear|spline\n");
+				fflush(output);
+				continue;
+			}
+			requested.interpolation = interpolations[m].interpolation;
+			if (context->weighted && liftContextConfigure(context, context->mode, &requested) != 0)
+			{
+				fprintf(output, "error a weighted angle of attack is outside the table\n");
+			}
+			else
+			{
+				current = requested;
+				fprintf(output, "ok\n");
+			}
+		}
+		else if ((status = parseOperatingPoint(text, &point)) > 0)
+		{
+			fprintf(output, "%f\n", liftContextLift(context, &point));
+		}
+		else if (status < 0)
+		{
+			fprintf(output, "error expected V h T Rh A, weights, integration or quit\n");
+		}
+		else
+		{
+			continue;
+		}
+		fflush(output);
+	}
+
+	return ferror(input) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,320 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Streaming summary of a stream of values, in constant memory: count, extremes, mean and variance
+ *	(Welford's update, and Chan et al.'s formula to merge two summaries), and a quantile sketch.
+ *
+ *	The sketch is a histogram with logarithmic buckets of ratio gamma = (1 + a) / (1 - a), one set for
+ *	positive and one for negative values, as in DDSketch: bucket k of either set holds the magnitudes
+ *	in (m gamma^(k-1), m gamma^k], where m is summaryMinMagnitude, and its quantile estimate is the
+ *	point of the bucket within a relative error a of all of them. Magnitudes below m count as zero;
+ *	those above the last bucket (m gamma^summaryBucketCount, about 1e12) fall into it and lose their
+ *	accuracy, but not the exact extremes. Bucket counts are integers, so merging summaries gives the same
+ *	sketch in any order.
+ */
+static double
+bucketGamma(void)
+{
+	return (1.0 + summaryRelativeAccuracy) / (1.0 - summaryRelativeAccuracy);
+}
+
+int
+streamingSummaryInit(StreamingSummary * summary)
+{
+	memset(summary, 0, sizeof(*summary));
+	summary->min			= HUGE_VAL;
+	summary->max			= -HUGE_VAL;
+	summary->inverseLogGamma	= 1.0 / log(bucketGamma());
+	summary->positive		= liftCalloc(summaryBucketCount, sizeof(uint64_t));
+	summary->negative		= liftCalloc(summaryBucketCount, sizeof(uint64_t));
+	if (summary->positive == NULL || summary->negative == NULL)
+	{
+		streamingSummaryFree(summary);
+		return -1;
+	}
+
+	return 0;
+}
+
+void
+streamingSummaryFree(StreamingSummary * summary)
+{
+	liftFree(summary->positive);
+	liftFree(summary->negative);
+	summary->positive = summary->negative = NULL;
+}
+
+void
+streamingSummaryAdd(StreamingSummary * summary, double value)
+{
+	double	magnitude = fabs(value);
+	double	delta = value - summary->mean;
+
+	summary->count++;
+	summary->mean	+= delta / summary->count;
+	summary->m2	+= delta * (value - summary->mean);
+	summary->min	= value < summary->min ? value : summary->min;
+	summary->max	= value > summary->max ? value : summary->max;
+
+	if (!(magnitude >= summaryMinMagnitude))
+	{
+		summary->zeroCount++;
+	}
+	else
+	{
+		double	index = ceil(log(magnitude / summaryMinMagnitude) * summary->inverseLogGamma);
+		size_t	bucket = index < summaryBucketCount ? (size_t) index : summaryBucketCount - 1;
+
+		(value > 0.0 ? summary->positive : summary->negative)[bucket]++;
+	}
+}
+
+void
+streamingSummaryAddValues(StreamingSummary * summary, const double * values, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		streamingSummaryAdd(summary, values[i]);
+	}
+}
+
+/*
+ *	Add the values summarised by `from` to `into`.
+ */
+void
+streamingSummaryMerge(StreamingSummary * into, const StreamingSummary * from)
+{
+	uint64_t	count = into->count + from->count;
+	double		delta = from->mean - into->mean;
+
+	if (from->count == 0)
+	{
+		return;
+	}
+	into->mean	+= delta * from->count / count;
+	into->m2	+= from->m2 + delta * delta * ((double) into->count * from->count / count);
+	into->count	= count;
+	into->min	= from->min < into->min ? from->min : into->min;
+	into->max	= from->max > into->max ? from->max : into->max;
+	into->zeroCount	+= from->zeroCount;
+	for (size_t k = 0; k < summaryBucketCount; k++)
+	{
+		into->positive[k] += from->positive[k];
+		into->negative[k] += from->negative[k];
+	}
+}
+
+double
+streamingSummaryStddev(const StreamingSummary * summary)
+{
+	return summary->count > 1 ? sqrt(summary->m2 / (summary->count - 1)) : 0.0;
+}
+
+/*
+ *	Estimate of the values in bucket k of either set.
+ */
+static double
+bucketValue(size_t k)
+{
+	double	gamma = bucketGamma();
+
+	return summaryMinMagnitude * 2.0 * pow(gamma, (double) k) / (gamma + 1.0);
+}
+
+static double
+clampToRange(const StreamingSummary * summary, double value)
+{
+	return value < summary->min ? summary->min : value > summary->max ? summary->max : value;
+}
+
+/*
+ *	Estimate of the value of rank floor(q (count - 1)) in sorted order, within the sketch's relative
+ *	accuracy and clamped to the exact extremes.
+ */
+double
+streamingSummaryQuantile(const StreamingSummary * summary, double q)
+{
+	uint64_t	rank;
+	uint64_t	seen = 0;
+
+	if (summary->count == 0)
+	{
+		return 0.0;
+	}
+	rank = (uint64_t) (q * (summary->count - 1));
+	for (size_t k = summaryBucketCount; k-- > 0;)
+	{
+		seen += summary->negative[k];
+		if (seen > rank)
+		{
+			return clampToRange(summary, -bucketValue(k));
+		}
+	}
+	seen += summary->zeroCount;
+	if (seen > rank)
+	{
+		return clampToRange(summary, 0.0);
+	}
+	for (size_t k = 0; k < summaryBucketCount; k++)
+	{
+		seen += summary->positive[k];
+		if (seen > rank)
+		{
+			return clampToRange(summary, bucketValue(k));
+		}
+	}
+
+	return summary->max;
+}
+
+/*
+ *	Summary file, in host byte order: SummaryFileHeader, then positiveBuckets and negativeBuckets
+ *	(bucket, count) pairs of uint64 for the non-empty buckets of either set, in ascending order.
+ */
+typedef struct
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrder;
+	uint32_t	bucketCount;
+	uint32_t	reserved;
+	double		relativeAccuracy;
+	uint64_t	count;
+	double		mean;
+	double		m2;
+	double		min;
+	double		max;
+	uint64_t	zeroCount;
+	uint64_t	positiveBuckets;
+	uint64_t	negativeBuckets;
+} SummaryFileHeader;
+
+static const char	summaryMagic[8] = {'L', 'I', 'F', 'T', 'S', 'U', 'M', '\0'};
+
+enum
+{
+	summaryFileVersion	= 1,
+};
+
+static uint64_t
+usedBuckets(const uint64_t * buckets)
+{
+	uint64_t	used = 0;
+
+	for (size_t k = 0; k < summaryBucketCount; k++)
+	{
+		used += buckets[k] != 0;
+	}
+
+	return used;
+}
+
+static int
+writeBuckets(FILE * file, const uint64_t * buckets)
+{
+	for (size_t k = 0; k < summaryBucketCount; k++)
+	{
+		uint64_t	pair[2] = {k, buckets[k]};
+
+		if (buckets[k] != 0 && fwrite(pair, sizeof(pair), 1, file) != 1)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int
+streamingSummaryWrite(const StreamingSummary * summary, const char * filename)
+{
+	SummaryFileHeader	header;
+	FILE *			file = fopen(filename, "wb");
+	int			status;
+
+	if (file == NULL)
+	{
+		return -1;
+	}
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, summaryMagic, sizeof(header.magic));
+	header.version		= summaryFileVersion;
+	header.byteOrder	= cpTableByteOrder;
+	header.bucketCount	= summaryBucketCount;
+	header.relativeAccuracy	= summaryRelativeAccuracy;
+	header.count		= summary->count;
+	header.mean		= summary->mean;
+	header.m2		= summary->m2;
+	header.min		= summary->min;
+	header.max		= summary->max;
+	header.zeroCount	= summary->zeroCount;
+	header.positiveBuckets	= usedBuckets(summary->positive);
+	header.negativeBuckets	= usedBuckets(summary->negative);
+
+	status = fwrite(&header, sizeof(header), 1, file) == 1 && writeBuckets(file, summary->positive) == 0 &&
+			writeBuckets(file, summary->negative) == 0 ? 0 : -1;
+
+	return fclose(file) != 0 ? -1 : status;
+}
+
+static int
+readBuckets(FILE * file, uint64_t pairs, uint64_t * buckets)
+{
+	for (uint64_t i = 0; i < pairs; i++)
+	{
+		uint64_t	pair[2];
+
+		if (fread(pair, sizeof(pair), 1, file) != 1 || pair[0] >= summaryBucketCount)
+		{
+			return -1;
+		}
+		buckets[pair[0]] = pair[1];
+	}
+
+	return 0;
+}
+
+int
+streamingSummaryRead(const char * filename, StreamingSummary * summary)
+{
+	SummaryFileHeader	header;
+	FILE *			file = fopen(filename, "rb");
+	int			status;
+
+	memset(summary, 0, sizeof(*summary));
+	if (file == NULL)
+	{
+		return -1;
+	}
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, summaryMagic, sizeof(summaryMagic)) != 0)
+	{
+		fclose(file);
+		return 1;
+	}
+	if (header.version != summaryFileVersion || header.byteOrder != cpTableByteOrder ||
+		header.bucketCount != summaryBucketCount || header.relativeAccuracy != summaryRelativeAccuracy ||
+		streamingSummaryInit(summary) != 0)
+	{
+		fclose(file);
+		return -1;
+	}
+	summary->count		= header.count;
+	summary->mean		= header.mean;
+	summary->m2		= header.m2;
+	summary->min		= header.min;
+	summary->max		= header.max;
+	summary->zeroCount	= header.zeroCount;
+
+	status = readBuckets(file, header.positiveBuckets, summary->positive) == 0 &&
+			readBuckets(file, header.negativeBuckets, summary->negative) == 0 ? 0 : -1;
+	fclose(file);
+	if (status != 0)
+	{
+		streamingSummaryFree(summary);
+	}
+
+	return status;
+}
@@ -0,0 +1,292 @@
+/*
+ *	Sweep engine.
+ *
+ *	A sweep is `count` independent points evaluated by `evaluate(context, worker, begin, end)` over index
+ *	ranges, each point writing only its own output slot, so results come out in input order whatever the
+ *	thread count or schedule. `worker`, the index of the calling thread (below the pool's threadCount),
+ *	lets an evaluation accumulate into per-thread state instead. Points are handed out in chunks of
+ *	sweepChunkSize:
+ *	-	SweepScheduleStatic gives every thread one contiguous run of chunks, which is the cheapest choice
+ *		when all points cost the same.
+ *	-	SweepScheduleSteal gives every thread the same initial run, but a thread that runs dry steals the
+ *		back half of the largest remaining run, so threads that hit expensive points are relieved by the
+ *		others.
+ *	The calling thread works as thread 0. Define LIFT_NO_THREADS to build without pthreads.
+ */
+#include <stdlib.h>
+#include "lift-core.h"
+#if !defined(LIFT_NO_THREADS)
+#include <unistd.h>
+#endif
+
+static void
+runChunk(const SweepJob * job, int worker, size_t chunk)
+{
+	size_t	begin	= chunk * sweepChunkSize;
+	size_t	end	= begin + sweepChunkSize < job->count ? begin + sweepChunkSize : job->count;
+
+	job->evaluate(job->context, worker, begin, end);
+}
+
+#if !defined(LIFT_NO_THREADS)
+/*
+ *	Take the next chunk of `range` into *chunk; returns 0 when the range is empty.
+ */
+static int
+takeChunk(SweepRange * range, size_t * chunk)
+{
+	int	found = 0;
+
+	pthread_mutex_lock(&range->lock);
+	if (range->next < range->end)
+	{
+		*chunk = range->next++;
+		found = 1;
+	}
+	pthread_mutex_unlock(&range->lock);
+
+	return found;
+}
+
+static size_t
+remainingChunks(SweepRange * range)
+{
+	size_t	remaining;
+
+	pthread_mutex_lock(&range->lock);
+	remaining = range->end - range->next;
+	pthread_mutex_unlock(&range->lock);
+
+	return remaining;
+}
+
+/*
+ *	Move the back half of the largest other range into `self`'s (empty) range. Returns 0 once no work is left.
+ */
+static int
+stealChunks(SweepPool * pool, int self)
+{
+	for (;;)
+	{
+		SweepRange *	victim	= NULL;
+		size_t		largest	= 0;
+
+		for (int t = 0; t < pool->threadCount; t++)
+		{
+			size_t	remaining = t == self ? 0 : remainingChunks(&pool->ranges[t]);
+
+			if (remaining > largest)
+			{
+				largest	= remaining;
+				victim	= &pool->ranges[t];
+			}
+		}
+		if (victim == NULL)
+		{
+			return 0;
+		}
+
+		pthread_mutex_lock(&victim->lock);
+		if (victim->next < victim->end)
+		{
+			size_t	half	= (victim->end - victim->next + 1) / 2;
+			size_t	begin	= victim->end - half;
+
+			victim->end = begin;
+			pthread_mutex_unlock(&victim->lock);
+
+			pthread_mutex_lock(&pool->ranges[self].lock);
+			pool->ranges[self].next	= begin;
+			pool->ranges[self].end	= begin + half;
+			pthread_mutex_unlock(&pool->ranges[self].lock);
+
+			return 1;
+		}
+		pthread_mutex_unlock(&victim->lock);
+	}
+}
+
+static void
+workOnSweep(SweepPool * pool, int self)
+{
+	size_t	chunk;
+
+	do
+	{
+		while (takeChunk(&pool->ranges[self], &chunk))
+		{
+			runChunk(pool->job, self, chunk);
+		}
+	} while (pool->schedule == SweepScheduleSteal && stealChunks(pool, self));
+}
+
+static void *
+sweepThread(void * argument)
+{
+	SweepWorker *	worker		= argument;
+	SweepPool *	pool		= worker->pool;
+	unsigned long	generation	= 0;
+
+	for (;;)
+	{
+		pthread_mutex_lock(&pool->lock);
+		while (!pool->stop && pool->generation == generation)
+		{
+			pthread_cond_wait(&pool->start, &pool->lock);
+		}
+		if (pool->stop)
+		{
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		generation = pool->generation;
+		pthread_mutex_unlock(&pool->lock);
+
+		workOnSweep(pool, worker->index);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->running == 0)
+		{
+			pthread_cond_signal(&pool->done);
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+#endif
+
+/*
+ *	threadCount <= 0 selects one thread per online core.
+ */
+int
+sweepPoolInit(SweepPool * pool, int threadCount, SweepSchedule schedule)
+{
+#if defined(LIFT_NO_THREADS)
+	threadCount = 1;
+#else
+	if (threadCount <= 0)
+	{
+		long	cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+		threadCount = cores > 0 ? (int) cores : 1;
+	}
+	if (threadCount > sweepMaxThreads)
+	{
+		threadCount = sweepMaxThreads;
+	}
+#endif
+
+	pool->threadCount	= threadCount;
+	pool->schedule		= schedule;
+	pool->job		= NULL;
+	pool->ranges		= liftCalloc(threadCount, sizeof(SweepRange));
+	if (pool->ranges == NULL)
+	{
+		return -1;
+	}
+
+#if !defined(LIFT_NO_THREADS)
+	pool->workers		= liftCalloc(threadCount, sizeof(SweepWorker));
+	pool->threads		= liftCalloc(threadCount, sizeof(pthread_t));
+	pool->generation	= 0;
+	pool->running		= 0;
+	pool->stop		= 0;
+	if (pool->workers == NULL || pool->threads == NULL)
+	{
+		liftFree(pool->workers);
+		liftFree(pool->threads);
+		liftFree(pool->ranges);
+		return -1;
+	}
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->start, NULL);
+	pthread_cond_init(&pool->done, NULL);
+
+	for (int t = 0; t < threadCount; t++)
+	{
+		pthread_mutex_init(&pool->ranges[t].lock, NULL);
+		pool->workers[t].pool	= pool;
+		pool->workers[t].index	= t;
+	}
+	for (int t = 1; t < threadCount; t++)
+	{
+		if (pthread_create(&pool->threads[t], NULL, sweepThread, &pool->workers[t]) != 0)
+		{
+			/*
+			 *	Run with the threads that did start.
+			 */
+			pool->threadCount = t;
+			break;
+		}
+	}
+#endif
+
+	return 0;
+}
+
+void
+sweepPoolDestroy(SweepPool * pool)
+{
+#if !defined(LIFT_NO_THREADS)
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (int t = 1; t < pool->threadCount; t++)
+	{
+		pthread_join(pool->threads[t], NULL);
+	}
+	for (int t = 0; t < pool->threadCount; t++)
+	{
+		pthread_mutex_destroy(&pool->ranges[t].lock);
+	}
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->start);
+	pthread_cond_destroy(&pool->done);
+	liftFree(pool->workers);
+	liftFree(pool->threads);
+#endif
+	liftFree(pool->ranges);
+}
+
+/*
+ *	Evaluate all points of `job` and return once every output slot has been written.
+ */
+void
+runSweep(SweepPool * pool, const SweepJob * job)
+{
+	size_t	chunkCount = (job->count + sweepChunkSize - 1) / sweepChunkSize;
+
+	if (pool->threadCount == 1 || chunkCount <= 1)
+	{
+		for (size_t chunk = 0; chunk < chunkCount; chunk++)
+		{
+			runChunk(job, 0, chunk);
+		}
+		return;
+	}
+
+#if !defined(LIFT_NO_THREADS)
+	for (int t = 0; t < pool->threadCount; t++)
+	{
+		pool->ranges[t].next	= chunkCount * t / pool->threadCount;
+		pool->ranges[t].end	= chunkCount * (t + 1) / pool->threadCount;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	pool->job	= job;
+	pool->running	= pool->threadCount - 1;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->lock);
+
+	workOnSweep(pool, 0);
+
+	pthread_mutex_lock(&pool->lock);
+	while (pool->running > 0)
+	{
+		pthread_cond_wait(&pool->done, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+#endif
+}
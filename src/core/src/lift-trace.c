@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <string.h>
+#include "lift-core.h"
+
+#if defined(LIFT_TRACE)
+#include <stdatomic.h>
+
+/*
+ *	Stage timers and counters of LIFT_TRACE builds.
+ *
+ *	Every span adds its duration to the totals of its stage. Spans of the coarse stages are also kept as
+ *	events, up to traceEventCapacity of them, for the trace-event output; the fine stages run once per
+ *	CSV line or per range of samples and are only totalled, so they cost two clock reads and two relaxed
+ *	atomic adds and no memory. Totals, counters and the event slots are atomics, so spans may end on any
+ *	thread.
+ */
+enum
+{
+	traceEventCapacity	= 1 << 16,
+};
+
+static const struct
+{
+	const char *	name;
+	int		events;		/* kept as events, not only totalled */
+} traceStages[traceStageCount] = {
+	[TraceStageRead]	= {"read",		1},
+	[TraceStageParse]	= {"parse",		0},
+	[TraceStageColumns]	= {"columns",		0},
+	[TraceStageVelocity]	= {"velocity",		1},
+	[TraceStageJoint]	= {"joint",		!LIFT_MONTE_CARLO},	/* the backend draws once per sample */
+	[TraceStageMonteCarlo]	= {"monte-carlo",	1},
+	[TraceStageSamples]	= {"samples",		0},
+	[TraceStageKernel]	= {"kernel",		0},
+};
+
+static const char *	traceCounterNames[traceCounterCount] = {
+	[TraceCounterBytes]	= "bytes",
+	[TraceCounterLines]	= "lines",
+	[TraceCounterAngles]	= "angles",
+	[TraceCounterSamples]	= "samples",
+	[TraceCounterPoints]	= "points",
+};
+
+typedef struct
+{
+	TraceStage	stage;
+	uint32_t	thread;
+	uint64_t	startNanoseconds;
+	uint64_t	nanoseconds;
+} TraceEvent;
+
+static _Atomic uint64_t		stageSpans[traceStageCount];
+static _Atomic uint64_t		stageNanoseconds[traceStageCount];
+static _Atomic uint64_t		counters[traceCounterCount];
+static _Atomic uint64_t		eventCount;	/* slots taken, including those beyond the capacity */
+static _Atomic uint32_t		threadCount;
+static TraceEvent		events[traceEventCapacity];
+static _Thread_local uint32_t	traceThread;	/* 0: not numbered yet */
+
+static void
+traceRecord(TraceStage stage, uint64_t start, uint64_t end)
+{
+	atomic_fetch_add_explicit(&stageSpans[stage], 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&stageNanoseconds[stage], end - start, memory_order_relaxed);
+	if (traceStages[stage].events)
+	{
+		uint64_t	slot = atomic_fetch_add_explicit(&eventCount, 1, memory_order_relaxed);
+
+		if (traceThread == 0)
+		{
+			traceThread = atomic_fetch_add_explicit(&threadCount, 1, memory_order_relaxed) + 1;
+		}
+		if (slot < traceEventCapacity)
+		{
+			events[slot] = (TraceEvent) {
+				.stage			= stage,
+				.thread			= traceThread,
+				.startNanoseconds	= start,
+				.nanoseconds		= end - start,
+			};
+		}
+	}
+}
+
+TraceSpan
+traceBegin(TraceStage stage)
+{
+	TraceSpan	span = {
+		.stage			= stage,
+		.startNanoseconds	= monotonicNanoseconds(),
+	};
+
+	return span;
+}
+
+void
+traceNext(TraceSpan * span, TraceStage stage)
+{
+	uint64_t	now = monotonicNanoseconds();
+
+	traceRecord(span->stage, span->startNanoseconds, now);
+	span->stage		= stage;
+	span->startNanoseconds	= now;
+}
+
+void
+traceEnd(const TraceSpan * span)
+{
+	traceRecord(span->stage, span->startNanoseconds, monotonicNanoseconds());
+}
+
+void
+traceCount(TraceCounter counter, uint64_t count)
+{
+	atomic_fetch_add_explicit(&counters[counter], count, memory_order_relaxed);
+}
+
+static void
+writeTotals(FILE * file)
+{
+	fprintf(file, "\"stages\": {");
+	for (int s = 0; s < traceStageCount; s++)
+	{
+		fprintf(file, "%s\"%s\": {\"spans\": %llu, \"ns\": %llu}", s > 0 ? ", " : "", traceStages[s].name,
+			(unsigned long long) atomic_load(&stageSpans[s]),
+			(unsigned long long) atomic_load(&stageNanoseconds[s]));
+	}
+	fprintf(file, "}, \"counters\": {");
+	for (int c = 0; c < traceCounterCount; c++)
+	{
+		fprintf(file, "%s\"%s\": %llu", c > 0 ? ", " : "", traceCounterNames[c],
+			(unsigned long long) atomic_load(&counters[c]));
+	}
+	fprintf(file, "}");
+}
+
+/*
+ *	Chrome trace events: one complete event per kept span, in microseconds from the first of them, and
+ *	the totals of every stage and the counters as trace metadata.
+ */
+static void
+writeEvents(FILE * file)
+{
+	uint64_t	taken = atomic_load(&eventCount);
+	size_t		kept = taken < traceEventCapacity ? (size_t) taken : traceEventCapacity;
+	uint64_t	origin = UINT64_MAX;
+
+	for (size_t e = 0; e < kept; e++)
+	{
+		origin = events[e].startNanoseconds < origin ? events[e].startNanoseconds : origin;
+	}
+	fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+	for (size_t e = 0; e < kept; e++)
+	{
+		fprintf(file, "{\"name\": \"%s\", \"cat\": \"lift\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+			"\"ts\": %.3f, \"dur\": %.3f}%s\n", traceStages[events[e].stage].name, events[e].thread,
+			(events[e].startNanoseconds - origin) / 1E3, events[e].nanoseconds / 1E3, e + 1 < kept ? "," : "");
+	}
+	fprintf(file, "], \"otherData\": {\"droppedEvents\": %llu, ", (unsigned long long) (taken - kept));
+	writeTotals(file);
+	fprintf(file, "}}\n");
+}
+
+/*
+ *	Write what has been traced so far to `filename`. Returns 0, or -1 if it cannot be written.
+ */
+int
+traceWrite(const char * filename, TraceFormat format)
+{
+	FILE *	file = fopen(filename, "w");
+	int	status;
+
+	if (file == NULL)
+	{
+		return -1;
+	}
+	if (format == TraceFormatEvents)
+	{
+		writeEvents(file);
+	}
+	else
+	{
+		fprintf(file, "{\"unit\": \"ns\", ");
+		writeTotals(file);
+		fprintf(file, "}\n");
+	}
+	status = ferror(file) ? -1 : 0;
+
+	return fclose(file) != 0 ? -1 : status;
+}
+#endif
+
+/*
+ *	Parse `json` or `trace-event`. Returns 0, or -1 if `name` is neither.
+ */
+int
+parseTraceFormat(const char * name, TraceFormat * format)
+{
+	static const char *	names[] = {
+		[TraceFormatJson]	= "json",
+		[TraceFormatEvents]	= "trace-event",
+	};
+
+	for (size_t f = 0; f < sizeof(names)/sizeof(names[0]); f++)
+	{
+		if (strcmp(name, names[f]) == 0)
+		{
+			*format = (TraceFormat) f;
+			return 0;
+		}
+	}
+
+	return -1;
+}
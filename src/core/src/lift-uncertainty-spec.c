@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Uncertainty specification file.
+ *
+ *	One `input = family parameters...` line per input, where input is V, h, T, Rh or A and family is
+ *	-	point x
+ *	-	uniform low high
+ *	-	gauss mean variance		(as libUncertainDoubleGaussDist())
+ *	-	samples x1 x2 ...		(empirical distribution, whitespace or `,` separated)
+ *	`#` starts a comment. `[name]` starts a scenario; lines before the first scenario set the defaults
+ *	of every scenario, and inputs that are never given keep v2's built-in distributions. A file without
+ *	scenarios describes a single unnamed one.
+ */
+static const char *	inputNames[] = {
+	[ModelInputV]	= "V",
+	[ModelInputH]	= "h",
+	[ModelInputT]	= "T",
+	[ModelInputRh]	= "Rh",
+	[ModelInputA]	= "A",
+};
+
+static const InputDistribution	builtInInputs[] = {
+	[ModelInputV]	= {.family = InputFamilyPoint, .parameters = {30.0}},
+	[ModelInputH]	= {.family = InputFamilyUniform, .parameters = {0.0, 11019.2}},
+	[ModelInputT]	= {.family = InputFamilyGauss, .parameters = {0.0, 50.0}},
+	[ModelInputRh]	= {.family = InputFamilyUniform, .parameters = {0.0, 1.0}},
+	[ModelInputA]	= {.family = InputFamilyPoint, .parameters = {2.3E-1}},
+};
+
+/*
+ *	Parse `family parameters...` into `distribution`. Returns 0, or -1 on malformed input.
+ */
+static int
+parseInputDistribution(char * text, InputDistribution * distribution)
+{
+	static const struct
+	{
+		const char *	name;
+		InputFamily	family;
+		size_t		parameters;
+	} families[] = {
+		{"point",	InputFamilyPoint,	1},
+		{"uniform",	InputFamilyUniform,	2},
+		{"gauss",	InputFamilyGauss,	2},
+		{"samples",	InputFamilySamples,	0},
+	};
+	size_t	length = strcspn(text, " \t");
+	char *	cursor = text + length;
+	size_t	capacity = 0;
+	size_t	parameterCount = 0;
+	size_t	expected = 0;
+
+	memset(distribution, 0, sizeof(*distribution));
+	for (size_t f = 0; f <= sizeof(families)/sizeof(families[0]); f++)
+	{
+		if (f == sizeof(families)/sizeof(families[0]))
+		{
+			return -1;
+		}
+		if (strlen(families[f].name) == length && strncmp(text, families[f].name, length) == 0)
+		{
+			distribution->family	= families[f].family;
+			expected		= families[f].parameters;
+			break;
+		}
+	}
+
+	for (;;)
+	{
+		char *	end;
+		double	value;
+
+		cursor += strspn(cursor, " \t,");
+		if (*cursor == '\0')
+		{
+			break;
+		}
+		value = strtod(cursor, &end);
+		if (end == cursor)
+		{
+			return -1;
+		}
+		cursor = end;
+
+		if (distribution->family != InputFamilySamples)
+		{
+			if (parameterCount == expected)
+			{
+				return -1;
+			}
+			distribution->parameters[parameterCount++] = value;
+			continue;
+		}
+		if (distribution->sampleCount == capacity)
+		{
+			size_t		grown = capacity == 0 ? 64 : capacity * 2;
+			double *	samples = liftRealloc(distribution->samples, grown * sizeof(double));
+
+			if (samples == NULL)
+			{
+				return -1;
+			}
+			distribution->samples	= samples;
+			capacity		= grown;
+		}
+		distribution->samples[distribution->sampleCount++] = value;
+	}
+
+	if (distribution->family == InputFamilySamples)
+	{
+		return distribution->sampleCount > 0 ? 0 : -1;
+	}
+
+	return parameterCount == expected ? 0 : -1;
+}
+
+static void
+inputDistributionFree(InputDistribution * distribution)
+{
+	liftFree(distribution->samples);
+	distribution->samples		= NULL;
+	distribution->sampleCount	= 0;
+}
+
+/*
+ *	Copy of `from` that owns its samples.
+ */
+static int
+inputDistributionCopy(InputDistribution * to, const InputDistribution * from)
+{
+	*to = *from;
+	if (from->samples == NULL)
+	{
+		return 0;
+	}
+	to->samples = liftMalloc(from->sampleCount * sizeof(double));
+	if (to->samples == NULL)
+	{
+		return -1;
+	}
+	memcpy(to->samples, from->samples, from->sampleCount * sizeof(double));
+
+	return 0;
+}
+
+/*
+ *	The value of an input: a plain double for point inputs, a distribution otherwise.
+ */
+static int
+inputDistributionValue(const InputDistribution * distribution, double * value)
+{
+	if (distribution->family == InputFamilyPoint)
+	{
+		*value = distribution->parameters[0];
+		return 0;
+	}
+#if LIFT_HAVE_UNCERTAIN
+	switch (distribution->family)
+	{
+	case InputFamilyUniform:
+		*value = libUncertainDoubleUniformDist(distribution->parameters[0], distribution->parameters[1]);
+		return 0;
+	case InputFamilyGauss:
+		*value = libUncertainDoubleGaussDist(distribution->parameters[0], distribution->parameters[1]);
+		return 0;
+	default:
+		*value = libUncertainDoubleDistFromSamples(distribution->samples, distribution->sampleCount);
+		return 0;
+	}
+#else
+	return -1;
+#endif
+}
+
+static UncertaintyScenario *
+addScenario(UncertaintySpecification * specification, const char * name, const InputDistribution * defaults)
+{
+	UncertaintyScenario *	scenario;
+	UncertaintyScenario *	grown = liftRealloc(specification->scenarios,
+					(specification->count + 1) * sizeof(UncertaintyScenario));
+
+	if (grown == NULL)
+	{
+		return NULL;
+	}
+	specification->scenarios = grown;
+	scenario = &grown[specification->count++];
+	memset(scenario, 0, sizeof(*scenario));
+	snprintf(scenario->name, sizeof(scenario->name), "%s", name);
+	for (int i = 0; i < modelInputCount; i++)
+	{
+		if (inputDistributionCopy(&scenario->inputs[i], &defaults[i]) != 0)
+		{
+			return NULL;
+		}
+	}
+
+	return scenario;
+}
+
+/*
+ *	Read a specification file. Returns 0, or -1 after reporting the offending line on stderr.
+ */
+int
+uncertaintySpecificationRead(const char * filename, UncertaintySpecification * specification)
+{
+	InputDistribution	defaults[modelInputCount];
+	UncertaintyScenario *	scenario = NULL;
+	FILE *			file = fopen(filename, "r");
+	char *			line = NULL;
+	size_t			capacity = 0;
+	size_t			lineNumber = 0;
+	int			status = 0;
+
+	memset(specification, 0, sizeof(*specification));
+	memcpy(defaults, builtInInputs, sizeof(defaults));
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open %s.\n", filename);
+		return -1;
+	}
+
+	while (status == 0 && getline(&line, &capacity, file) >= 0)
+	{
+		char *			text = line + strspn(line, " \t");
+		size_t			length;
+		InputDistribution *	target = NULL;
+
+		lineNumber++;
+		text[strcspn(text, "#\r\n")] = '\0';
+		length = strlen(text);
+		while (length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\t'))
+		{
+			text[--length] = '\0';
+		}
+		if (length == 0)
+		{
+			continue;
+		}
+
+		if (text[0] == '[' && text[length - 1] == ']')
+		{
+			text[length - 1] = '\0';
+			scenario = addScenario(specification, text + 1, defaults);
+			status = scenario == NULL ? -1 : 0;
+			continue;
+		}
+
+		length = strcspn(text, " \t=");
+		for (int i = 0; i < modelInputCount; i++)
+		{
+			if (strlen(inputNames[i]) == length && strncmp(text, inputNames[i], length) == 0)
+			{
+				target = scenario != NULL ? &scenario->inputs[i] : &defaults[i];
+			}
+		}
+		text += length + strspn(text + length, " \t");
+		if (target == NULL || *text != '=')
+		{
+			fprintf(stderr, "%s:%zu: expected `V|h|T|Rh|A = family parameters...`\n", filename, lineNumber);
+			status = -1;
+			continue;
+		}
+		inputDistributionFree(target);
+		if (parseInputDistribution(text + 1 + strspn(text + 1, " \t"), target) != 0)
+		{
+			fprintf(stderr, "%s:%zu: expected point x, uniform low high, gauss mean variance or samples x...\n",
+				filename, lineNumber);
+			status = -1;
+		}
+	}
+	free(line);
+	fclose(file);
+
+	if (status == 0 && specification->count == 0 && addScenario(specification, "", defaults) == NULL)
+	{
+		status = -1;
+	}
+	for (int i = 0; i < modelInputCount; i++)
+	{
+		inputDistributionFree(&defaults[i]);
+	}
+	if (status != 0)
+	{
+		uncertaintySpecificationFree(specification);
+	}
+
+	return status;
+}
+
+/*
+ *	Operating point of a scenario: the value of each of its inputs. With the Monte Carlo backend, this
+ *	is one sample of the current stream and `scenario` is left alone, so threads can share it.
+ */
+int
+uncertaintyScenarioSample(const UncertaintyScenario * scenario, OperatingPoint * point)
+{
+	double	values[modelInputCount];
+
+	for (int i = 0; i < modelInputCount; i++)
+	{
+		if (inputDistributionValue(&scenario->inputs[i], &values[i]) != 0)
+		{
+			return -1;
+		}
+	}
+	point->V	= values[ModelInputV];
+	point->h	= values[ModelInputH];
+	point->T	= values[ModelInputT];
+	point->Rh	= values[ModelInputRh];
+	point->A	= values[ModelInputA];
+
+	return 0;
+}
+
+/*
+ *	Build the distributions of every scenario, and its atmosphere, once.
+ */
+int
+uncertaintySpecificationBuild(UncertaintySpecification * specification)
+{
+	for (size_t s = 0; s < specification->count; s++)
+	{
+		UncertaintyScenario *	scenario = &specification->scenarios[s];
+
+		if (uncertaintyScenarioSample(scenario, &scenario->point) != 0)
+		{
+			return -1;
+		}
+		atmosphereContextInit(&scenario->atmosphere, scenario->point.h, scenario->point.T, scenario->point.Rh);
+	}
+
+	return 0;
+}
+
+/*
+ *	Scenario called `name`, or NULL.
+ */
+const UncertaintyScenario *
+uncertaintySpecificationFind(const UncertaintySpecification * specification, const char * name)
+{
+	for (size_t s = 0; s < specification->count; s++)
+	{
+		if (strcmp(specification->scenarios[s].name, name) == 0)
+		{
+			return &specification->scenarios[s];
+		}
+	}
+
+	return NULL;
+}
+
+void
+uncertaintySpecificationFree(UncertaintySpecification * specification)
+{
+	for (size_t s = 0; s < specification->count; s++)
+	{
+		for (int i = 0; i < modelInputCount; i++)
+		{
+			inputDistributionFree(&specification->scenarios[s].inputs[i]);
+		}
+	}
+	liftFree(specification->scenarios);
+	memset(specification, 0, sizeof(*specification));
+}
@@ -0,0 +1,505 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+enum
+{
+	benchPointCount		= 4096,
+	benchSetupIterations	= 1000,
+	benchTableIterations	= 10,
+};
+
+/*
+ *	Stages of v1: parse (one `V h T Rh A` line), setup (velocity factors of the Cp tables) and evaluate,
+ *	through the single-point path, the incremental model with only V changing, the batch kernel in double
+ *	and in single precision, and the density table: building it and the batch evaluation that
+ *	interpolates the density instead of computing it.
+ */
+static int
+runBench(uint64_t iterations, const size_t densityNodes[2])
+{
+	static char		lines[benchPointCount][96];
+	OperatingPointBlock *	block = liftMalloc(sizeof(*block));
+	VelocityFactors		factors;
+	DensityTable		density;
+	BenchStage		stage;
+	OperatingPoint		point;
+	uint64_t		state = 1;
+	double			sum = 0.0;
+	double			singleError = 0.0;
+
+	if (block == NULL)
+	{
+		return EXIT_FAILURE;
+	}
+	for (size_t i = 0; i < benchPointCount; i++)
+	{
+		double	u[5];
+
+		for (int j = 0; j < 5; j++)
+		{
+			state = state * 6364136223846793005u + 1442695040888963407u;
+			u[j] = (state >> 11) * 0x1.0p-53;
+		}
+		snprintf(lines[i], sizeof(lines[i]), "%.6f %.3f %.3f %.4f %.4f", 10.0 + 333.0 * u[0], 11019.0 * u[1],
+			-50.0 + 100.0 * u[2], u[3], 0.1 + 0.9 * u[4]);
+	}
+
+	benchHeader("v1");
+
+	benchBegin(&stage, "parse", iterations);
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		parseOperatingPoint(lines[i % benchPointCount], &point);
+		sum += point.V;
+	}
+	benchEnd(&stage);
+
+	benchBegin(&stage, "setup", benchSetupIterations);
+	for (uint64_t i = 0; i < benchSetupIterations; i++)
+	{
+		precomputeEmbeddedVelocityFactors(&factors);
+		sum += factors.over;
+	}
+	benchEnd(&stage);
+
+	block->count		= benchPointCount;
+	block->factors		= &factors;
+	block->density		= NULL;
+	block->precision	= KernelPrecisionDouble;
+	for (size_t i = 0; i < benchPointCount; i++)
+	{
+		parseOperatingPoint(lines[i], &point);
+		block->V[i]		= point.V;
+		block->h[i]		= point.h;
+		block->T[i]		= point.T;
+		block->Rh[i]		= point.Rh;
+		block->A[i]		= point.A;
+		block->single.V[i]	= (float) point.V;
+		block->single.h[i]	= (float) point.h;
+		block->single.T[i]	= (float) point.T;
+		block->single.Rh[i]	= (float) point.Rh;
+		block->single.A[i]	= (float) point.A;
+	}
+
+	benchBegin(&stage, "evaluate", iterations);
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		size_t		j = i % benchPointCount;
+		OperatingPoint	p = {block->V[j], block->h[j], block->T[j], block->Rh[j], block->A[j]};
+
+		sum += computeLift(&p, &factors);
+	}
+	benchEnd(&stage);
+
+	/*
+	 *	Only V changes between evaluations, as in an optimisation loop over the free stream velocity.
+	 */
+	benchBegin(&stage, "evaluate-incremental", iterations);
+	{
+		IncrementalModel	model;
+
+		incrementalModelInit(&model, &point, &factors);
+		for (uint64_t i = 0; i < iterations; i++)
+		{
+			incrementalModelSet(&model, ModelInputV, block->V[i % benchPointCount]);
+			sum += incrementalModelLift(&model);
+		}
+	}
+	benchEnd(&stage);
+
+	benchBegin(&stage, "evaluate-kernel", (iterations + benchPointCount - 1) / benchPointCount * benchPointCount);
+	for (uint64_t i = 0; i < iterations; i += benchPointCount)
+	{
+		evaluateBlockRange(block, 0, 0, benchPointCount);
+		sum += block->lift[i % benchPointCount];
+	}
+	benchEnd(&stage);
+
+	block->precision = KernelPrecisionSingle;
+	benchBegin(&stage, "evaluate-kernel-single", (iterations + benchPointCount - 1) / benchPointCount * benchPointCount);
+	for (uint64_t i = 0; i < iterations; i += benchPointCount)
+	{
+		evaluateBlockRange(block, 0, 0, benchPointCount);
+		sum += block->single.lift[i % benchPointCount];
+	}
+	benchEnd(&stage);
+	for (size_t i = 0; i < benchPointCount; i++)
+	{
+		double	error = fabs(block->single.lift[i] - block->lift[i]) / fabs(block->lift[i]);
+
+		singleError = error > singleError ? error : singleError;
+	}
+	printf("# single precision kernel, max relative error %.3g\n", singleError);
+	block->precision = KernelPrecisionDouble;
+
+	benchBegin(&stage, "setup-density-table", benchTableIterations);
+	for (uint64_t i = 0; i < benchTableIterations; i++)
+	{
+		if (densityTableInit(&density, densityNodes[0], densityNodes[1]) != 0)
+		{
+			liftFree(block);
+			return EXIT_FAILURE;
+		}
+		sum += density.maxError;
+		if (i + 1 < benchTableIterations)
+		{
+			densityTableFree(&density);
+		}
+	}
+	benchEnd(&stage);
+
+	block->density = &density;
+	benchBegin(&stage, "evaluate-density-table", (iterations + benchPointCount - 1) / benchPointCount * benchPointCount);
+	for (uint64_t i = 0; i < iterations; i += benchPointCount)
+	{
+		evaluateBlockRange(block, 0, 0, benchPointCount);
+		sum += block->lift[i % benchPointCount];
+	}
+	benchEnd(&stage);
+	printf("# density table %zux%zu, max relative error %.3g\n", density.hCount, density.TCount, density.maxError);
+	densityTableFree(&density);
+
+	benchSink = sum;
+	liftFree(block);
+
+	return EXIT_SUCCESS;
+}
+
+static void
+printGradient(FILE * output, const LiftGradient * gradient)
+{
+	fprintf(output, "%f %g %g %g %g %g %g\n", gradient->lift, gradient->V, gradient->A, gradient->h, gradient->T,
+		gradient->Rh, gradient->angle);
+}
+
+/*
+ *	--gradient: lift and its derivatives with respect to V, A, h, T, Rh and the angle of attack, at the
+ *	default operating point or at every `V h T Rh A` line of a batch (one `lift dV dA dh dT dRh dAoA` line
+ *	per point).
+ */
+static int
+runGradient(const ModelOptions * options, const VelocityFactors * factors, const VelocityFactors * slopes)
+{
+	FILE *		input = stdin;
+	LiftGradient	gradient;
+	char		line[1024];
+	size_t		lineNumber = 0;
+	int		status = EXIT_SUCCESS;
+
+	if (!options->batch)
+	{
+		computeLiftGradient(&defaultOperatingPoint, factors, slopes, &gradient);
+		printf("Lift force = %f N\n", gradient.lift);
+		printf("dFl/dV   = %g N s/m\n", gradient.V);
+		printf("dFl/dA   = %g N/m^2\n", gradient.A);
+		printf("dFl/dh   = %g N/m\n", gradient.h);
+		printf("dFl/dT   = %g N/°C\n", gradient.T);
+		printf("dFl/dRh  = %g N\n", gradient.Rh);
+		printf("dFl/dAoA = %g N/°\n", gradient.angle);
+
+		return 0;
+	}
+
+	if (options->batchFile != NULL && strcmp(options->batchFile, "-") != 0)
+	{
+		input = fopen(options->batchFile, "r");
+		if (input == NULL)
+		{
+			fprintf(stderr, "Could not open %s.\n", options->batchFile);
+			return EXIT_FAILURE;
+		}
+	}
+	while (status == EXIT_SUCCESS && fgets(line, sizeof(line), input))
+	{
+		OperatingPoint	point;
+		int		parsed;
+
+		lineNumber++;
+		if (lineTruncated(line, input))
+		{
+			fprintf(stderr, "line %zu: longer than %zu characters\n", lineNumber, sizeof(line) - 2);
+			status = EXIT_FAILURE;
+			break;
+		}
+		parsed = parseOperatingPoint(line, &point);
+		if (parsed < 0)
+		{
+			fprintf(stderr, "line %zu: expected `V h T Rh A`\n", lineNumber);
+			status = EXIT_FAILURE;
+		}
+		else if (parsed > 0)
+		{
+			computeLiftGradient(&point, factors, slopes, &gradient);
+			printGradient(stdout, &gradient);
+		}
+	}
+	if (ferror(input))
+	{
+		status = EXIT_FAILURE;
+	}
+	if (input != stdin)
+	{
+		fclose(input);
+	}
+
+	return status;
+}
+
+/*
+ *	Velocity factors of every value of the grid's angle axis: `factors` when it is not swept, otherwise
+ *	from the airfoil database, or from the spline through the built-in curves without one.
+ */
+static int
+gridAngleFactors(const ModelOptions * options, const AirfoilDatabase * database, const VelocityFactors * factors,
+		VelocityFactors ** angleFactors)
+{
+	const GridRange *	angles = &options->grid->axes[GridAxisAngle];
+	CpTable			table;
+
+	*angleFactors = liftMalloc((angles->count > 0 ? angles->count : 1) * sizeof(VelocityFactors));
+	if (*angleFactors == NULL)
+	{
+		fprintf(stderr, "Could not allocate the velocity factors of the grid.\n");
+		return -1;
+	}
+	if (angles->count == 0)
+	{
+		(*angleFactors)[0] = *factors;
+		return 0;
+	}
+
+	cpTableEmbedded(&table);
+	for (uint64_t k = 0; k < angles->count; k++)
+	{
+		double		angle = sweepGridValue(angles, k);
+		VelocityFactors	slopes;
+		CurvePlan	plan;
+		int		status;
+
+		if (database != NULL)
+		{
+			status = airfoilDatabaseLookup(database, options->airfoil, options->reynolds, angle,
+					&(*angleFactors)[k], &slopes);
+		}
+		else if ((status = curvePlanInit(&plan, &table.layout, angle, AngleInterpolationSpline)) == 0)
+		{
+			(*angleFactors)[k].over		= plannedVelocityFactor(&table, &plan, CpSurfaceOver, options->integration);
+			(*angleFactors)[k].under	= plannedVelocityFactor(&table, &plan, CpSurfaceUnder, options->integration);
+		}
+		if (status != 0)
+		{
+			if (database != NULL)
+			{
+				fprintf(stderr, "%s has no airfoil %s covering an angle of attack of %g°.\n",
+					options->airfoilManifest, options->airfoil, angle);
+			}
+			else
+			{
+				fprintf(stderr, "The built-in Cp table does not cover an angle of attack of %g°.\n", angle);
+			}
+			liftFree(*angleFactors);
+			*angleFactors = NULL;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ *	--grid: this node's shard of the grid, with its results numbered by their index in the whole grid,
+ *	and with --summary, the summary of its lift.
+ */
+static int
+runGridShard(const ModelOptions * options, const VelocityFactors * angleFactors, ResultWriter * writer,
+		const DensityTable * density, GpuDevice * gpu, SweepPool * pool)
+{
+	StreamingSummary	summary;
+	uint64_t		begin;
+	uint64_t		end;
+	int			status;
+
+	if (options->summaryFile != NULL && streamingSummaryInit(&summary) != 0)
+	{
+		fprintf(stderr, "Could not allocate the summary.\n");
+		return EXIT_FAILURE;
+	}
+	sweepGridShard(options->grid, options->shard, options->shardCount > 0 ? options->shardCount : 1, &begin, &end);
+	writer->written = begin;
+
+	status = runGrid(options->grid, begin, end, angleFactors, writer, options->summaryFile != NULL ? &summary : NULL,
+			density, options->precision, gpu, pool);
+	if (options->summaryFile != NULL)
+	{
+		if (status == EXIT_SUCCESS && streamingSummaryWrite(&summary, options->summaryFile) != 0)
+		{
+			fprintf(stderr, "Could not write %s.\n", options->summaryFile);
+			status = EXIT_FAILURE;
+		}
+		streamingSummaryFree(&summary);
+	}
+
+	return status;
+}
+
+/*
+ *	v1: lift at the default operating point, or at every point of a batch or of a grid.
+ */
+int
+runNoUncertainties(const ModelOptions * options)
+{
+	VelocityFactors		factors;
+	VelocityFactors		slopes;
+	VelocityFactors *	angleFactors = NULL;
+
+	if (options->bench)
+	{
+		size_t	defaultNodes[2] = {densityTableDefaultNodes, densityTableDefaultNodes};
+
+		return runBench(options->benchIterations > 0 ? options->benchIterations : 1000000,
+				options->densityNodes[0] > 0 ? options->densityNodes : defaultNodes);
+	}
+
+	if (options->airfoilManifest != NULL)
+	{
+		AirfoilDatabase	database;
+		int		status;
+
+		if (airfoilDatabaseRead(options->airfoilManifest, options->integration, &database) != 0)
+		{
+			return EXIT_FAILURE;
+		}
+		status = airfoilDatabaseLookup(&database, options->airfoil, options->reynolds, options->angleOfAttack,
+				&factors, &slopes);
+		if (status != 0)
+		{
+			fprintf(stderr, "%s has no airfoil %s covering an angle of attack of %g°.\n",
+				options->airfoilManifest, options->airfoil, options->angleOfAttack);
+		}
+		else if (options->grid != NULL)
+		{
+			status = gridAngleFactors(options, &database, &factors, &angleFactors);
+		}
+		airfoilDatabaseFree(&database);
+		if (status != 0)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		precomputeEmbeddedVelocityFactors(&factors);
+		embeddedVelocityFactorSlopes(&slopes);
+		if (options->grid != NULL && gridAngleFactors(options, NULL, &factors, &angleFactors) != 0)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (options->gradient)
+	{
+		return runGradient(options, &factors, &slopes);
+	}
+
+	if (options->batch || options->grid != NULL)
+	{
+		FILE *		input = stdin;
+		SweepPool	pool;
+		DensityTable	density;
+		ResultWriter	writer;
+		GpuDevice *	gpu = NULL;
+		int		densityBuilt = 0;
+		int		pooled = 0;
+		int		status = EXIT_SUCCESS;
+
+		/*
+		 *	Every failure from here on goes through the cleanup at the end of the block, which releases
+		 *	whatever was set up before it.
+		 */
+		if (options->batch && options->batchFile != NULL && strcmp(options->batchFile, "-") != 0 &&
+			(input = fopen(options->batchFile, "r")) == NULL)
+		{
+			fprintf(stderr, "Could not open %s.\n", options->batchFile);
+			input	= stdin;
+			status	= EXIT_FAILURE;
+		}
+		if (status == EXIT_SUCCESS && options->densityNodes[0] > 0)
+		{
+			densityBuilt = densityTableInit(&density, options->densityNodes[0], options->densityNodes[1]) == 0;
+			if (!densityBuilt)
+			{
+				fprintf(stderr, "Could not build the density table.\n");
+				status = EXIT_FAILURE;
+			}
+		}
+		if (status == EXIT_SUCCESS)
+		{
+			pooled = sweepPoolInit(&pool, options->threadCount, options->schedule) == 0;
+			if (!pooled)
+			{
+				fprintf(stderr, "Could not set up the sweep threads.\n");
+				status = EXIT_FAILURE;
+			}
+		}
+#if defined(LIFT_CUDA)
+		if (status == EXIT_SUCCESS && options->gpu && (gpu = gpuOpen()) == NULL)
+		{
+			fprintf(stderr, "No CUDA device is available.\n");
+			status = EXIT_FAILURE;
+		}
+#endif
+
+		/*
+		 *	Text sweeps produce one short line per point; a large stdout buffer keeps the
+		 *	per-point cost in the model rather than in write(2). Binary results bypass it.
+		 */
+		if (status == EXIT_SUCCESS)
+		{
+			setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+		}
+		if (status == EXIT_SUCCESS && resultWriterInit(&writer, stdout, options->resultFormat) != 0)
+		{
+			fprintf(stderr, "Could not write the results.\n");
+			status = EXIT_FAILURE;
+		}
+		else if (status == EXIT_SUCCESS)
+		{
+			status = options->grid != NULL ?
+					runGridShard(options, angleFactors, &writer, options->densityNodes[0] > 0 ? &density : NULL,
+						gpu, &pool) :
+					runBatch(input, &writer, &factors, options->densityNodes[0] > 0 ? &density : NULL,
+						options->precision, gpu, &pool);
+			if (resultWriterFinish(&writer) != 0 && status == EXIT_SUCCESS)
+			{
+				fprintf(stderr, "Could not write the results.\n");
+				status = EXIT_FAILURE;
+			}
+		}
+
+		if (pooled)
+		{
+			sweepPoolDestroy(&pool);
+		}
+#if defined(LIFT_CUDA)
+		gpuClose(gpu);
+#endif
+		if (densityBuilt)
+		{
+			densityTableFree(&density);
+		}
+		if (input != stdin)
+		{
+			fclose(input);
+		}
+		liftFree(angleFactors);
+
+		return status;
+	}
+
+	printf("Lift force = %f N\n", computeLift(&defaultOperatingPoint, &factors));
+
+	return 0;
+}
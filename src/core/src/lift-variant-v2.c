@@ -0,0 +1,517 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+#if LIFT_HAVE_UNCERTAIN
+/*
+ *	Free stream velocity and area of v2's single evaluation.
+ */
+static const double	defaultVelocity	= 30.0;
+static const double	defaultArea	= 2.3E-1;
+
+/*
+ *	Atmosphere of v2: humidity, elevation and temperature are uncertain, and so is the density computed
+ *	from them.
+ */
+static void
+loadUncertainAtmosphere(AtmosphereContext * atmosphere)
+{
+	double Rh = libUncertainDoubleUniformDist(0.0, 1.0);
+	double h  = libUncertainDoubleUniformDist(0.0, 11019.2);
+	double T  = libUncertainDoubleGaussDist(0.0, 50.0);
+
+	atmosphereContextInit(atmosphere, h, T, Rh);
+}
+
+/*
+ *	`Lift force = ... N`, prefixed with the name of the scenario if it has one.
+ */
+static void
+printLift(const char * scenario, double lift)
+{
+	if (scenario[0] == '\0')
+	{
+		printf("Lift force = %f N\n", lift);
+	}
+	else
+	{
+		printf("%s: Lift force = %f N\n", scenario, lift);
+	}
+}
+
+/*
+ *	Parse one `V A` line. Returns 1 on success, 0 for blank/comment lines and -1 on malformed input.
+ */
+static int
+parseVelocityArea(const char * line, double * V, double * A)
+{
+	char *	end;
+
+	while (*line == ' ' || *line == '\t')
+	{
+		line++;
+	}
+	if (*line == '\0' || *line == '\n' || *line == '\r' || *line == '#')
+	{
+		return 0;
+	}
+	*V = strtod(line, &end);
+	if (end == line)
+	{
+		return -1;
+	}
+	line = end + strspn(end, " \t,;");
+	*A = strtod(line, &end);
+
+	return end == line ? -1 : 1;
+}
+
+/*
+ *	--batch: lift for every `V A` line of `input`, all against the same uncertain atmosphere.
+ */
+static int
+runBatchAtmosphere(FILE * input, const AtmosphereContext * atmosphere, const VelocityFactors * factors)
+{
+	char	line[1024];
+	size_t	lineNumber = 0;
+
+	while (fgets(line, sizeof(line), input))
+	{
+		double	V, A;
+		int	status;
+
+		lineNumber++;
+		status = parseVelocityArea(line, &V, &A);
+		if (status == 0)
+		{
+			continue;
+		}
+		if (status < 0)
+		{
+			fprintf(stderr, "line %zu: expected `V A`\n", lineNumber);
+			return EXIT_FAILURE;
+		}
+		printf("%f\n", atmosphereLift(atmosphere, factors, V, A));
+	}
+
+	return ferror(input) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#if LIFT_MONTE_CARLO
+/*
+ *	Monte Carlo backend: each result is estimated from options->samples evaluations, each with its own
+ *	draw of the inputs. Lift samples go through liftKernel() a chunk at a time; a batch only needs the
+ *	mean density, since the lift is linear in it.
+ */
+enum
+{
+	monteCarloChunk	= 256,
+};
+
+typedef struct
+{
+	const UncertaintyScenario *	scenario;	/* NULL: v2's built-in distributions */
+	const VelocityFactors *		factors;
+} MonteCarloLift;
+
+/*
+ *	Inputs of sample `sample`, drawn in the same order as loadUncertainAtmosphere().
+ */
+static void
+sampleOperatingPoint(const UncertaintyScenario * scenario, uint64_t sample, OperatingPoint * point)
+{
+	monteCarloSelectSample(sample);
+	if (scenario != NULL)
+	{
+		uncertaintyScenarioSample(scenario, point);
+		return;
+	}
+	point->Rh	= libUncertainDoubleUniformDist(0.0, 1.0);
+	point->h	= libUncertainDoubleUniformDist(0.0, 11019.2);
+	point->T	= libUncertainDoubleGaussDist(0.0, 50.0);
+	point->V	= defaultVelocity;
+	point->A	= defaultArea;
+}
+
+static void
+evaluateLiftSamples(void * context, uint64_t first, size_t count, double * values)
+{
+	const MonteCarloLift *	job = context;
+	double			V[monteCarloChunk], h[monteCarloChunk], T[monteCarloChunk];
+	double			Rh[monteCarloChunk], A[monteCarloChunk];
+
+	for (size_t begin = 0; begin < count; begin += monteCarloChunk)
+	{
+		size_t	chunk = count - begin < monteCarloChunk ? count - begin : monteCarloChunk;
+
+		for (size_t i = 0; i < chunk; i++)
+		{
+			OperatingPoint	point;
+
+			sampleOperatingPoint(job->scenario, first + begin + i, &point);
+			V[i]	= point.V;
+			h[i]	= point.h;
+			T[i]	= point.T;
+			Rh[i]	= point.Rh;
+			A[i]	= point.A;
+		}
+		liftKernel(chunk, V, h, T, Rh, A, job->factors, values + begin);
+	}
+}
+
+static void
+evaluateDensitySamples(void * context, uint64_t first, size_t count, double * values)
+{
+	const MonteCarloLift *	job = context;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		OperatingPoint		point;
+		AtmosphereContext	atmosphere;
+
+		sampleOperatingPoint(job->scenario, first + i, &point);
+		atmosphereContextInit(&atmosphere, point.h, point.T, point.Rh);
+		values[i] = atmosphere.r;
+	}
+}
+
+#if defined(LIFT_CUDA)
+/*
+ *	The draws of sampleOperatingPoint() as a model the device can run, for --gpu. Returns 0, or -1 if an
+ *	input of the scenario is given as samples, which the device does not draw.
+ */
+static int
+monteCarloModel(const MonteCarloLift * job, int density, MonteCarloModel * model)
+{
+	static const MonteCarloDraw	builtInDraws[] = {
+		{MonteCarloDrawUniform,	ModelInputRh,	{0.0, 1.0}},
+		{MonteCarloDrawUniform,	ModelInputH,	{0.0, 11019.2}},
+		{MonteCarloDrawGauss,	ModelInputT,	{0.0, 50.0}},
+	};
+	double				values[modelInputCount] = {defaultVelocity, 0.0, 0.0, 0.0, defaultArea};
+
+	memset(model, 0, sizeof(*model));
+	model->density = density;
+	if (job->factors != NULL)
+	{
+		model->factors = *job->factors;
+	}
+	if (job->scenario == NULL)
+	{
+		model->drawCount = sizeof(builtInDraws)/sizeof(builtInDraws[0]);
+		memcpy(model->draws, builtInDraws, sizeof(builtInDraws));
+	}
+	for (int i = 0; job->scenario != NULL && i < modelInputCount; i++)
+	{
+		const InputDistribution *	input = &job->scenario->inputs[i];
+		MonteCarloDraw *		draw = &model->draws[model->drawCount];
+
+		switch (input->family)
+		{
+		case InputFamilyPoint:
+			values[i] = input->parameters[0];
+			continue;
+		case InputFamilyUniform:
+			draw->kind = MonteCarloDrawUniform;
+			break;
+		case InputFamilyGauss:
+			draw->kind = MonteCarloDrawGauss;
+			break;
+		default:
+			return -1;
+		}
+		draw->input		= (ModelInput) i;
+		draw->parameters[0]	= input->parameters[0];
+		draw->parameters[1]	= input->parameters[1];
+		model->drawCount++;
+	}
+	model->point.V	= values[ModelInputV];
+	model->point.h	= values[ModelInputH];
+	model->point.T	= values[ModelInputT];
+	model->point.Rh	= values[ModelInputRh];
+	model->point.A	= values[ModelInputA];
+
+	return 0;
+}
+#endif
+
+static int
+estimate(const ModelOptions * options, MonteCarloEvaluate evaluate, const MonteCarloLift * job,
+	MonteCarloSummary * summary)
+{
+	MonteCarloOptions	run = {
+		.samples	= options->samples > 0 ? options->samples : monteCarloDefaultSamples,
+		.seed		= options->seed,
+		.sampler	= options->sampler,
+		.threadCount	= options->threadCount,
+	};
+#if defined(LIFT_CUDA)
+	MonteCarloModel		model;
+
+	if (options->gpu)
+	{
+		if (monteCarloModel(job, evaluate == evaluateDensitySamples, &model) != 0)
+		{
+			fprintf(stderr, "--gpu cannot draw inputs given as samples.\n");
+			return -1;
+		}
+		run.gpu = &model;
+	}
+#endif
+
+	if (monteCarloEstimate(&run, evaluate, (void *) job, summary) != 0)
+	{
+		fprintf(stderr, "Could not run %llu Monte Carlo samples.\n", (unsigned long long) run.samples);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ *	Lift of `scenario` (or of v2's built-in distributions): its mean, then the summary line.
+ */
+static int
+printMonteCarloLift(const ModelOptions * options, const UncertaintyScenario * scenario,
+	const VelocityFactors * factors)
+{
+	MonteCarloLift		job = {.scenario = scenario, .factors = factors};
+	MonteCarloSummary	summary;
+
+	if (estimate(options, evaluateLiftSamples, &job, &summary) != 0)
+	{
+		return -1;
+	}
+	printLift(scenario != NULL ? scenario->name : "", summary.mean);
+	monteCarloPrintSummary(stdout, &summary);
+
+	return 0;
+}
+
+/*
+ *	Atmosphere with the mean density of `scenario`, for --batch.
+ */
+static int
+meanAtmosphere(const ModelOptions * options, const UncertaintyScenario * scenario, AtmosphereContext * atmosphere)
+{
+	MonteCarloLift		job = {.scenario = scenario};
+	MonteCarloSummary	summary;
+
+	if (estimate(options, evaluateDensitySamples, &job, &summary) != 0)
+	{
+		return -1;
+	}
+	atmosphere->r = summary.mean;
+
+	return 0;
+}
+#endif
+
+enum
+{
+	benchSetupIterations	= 1000,
+};
+
+/*
+ *	Stages of v2: setup (velocity factors of the Cp tables), setup-atmosphere (uncertain inputs and
+ *	density chain), evaluate (uncertain inputs, density chain and lift for every evaluation) and
+ *	evaluate-context (lift for varying V and A against one atmosphere). v2 reads no input, so there is no
+ *	parse stage.
+ */
+static int
+runBench(uint64_t iterations)
+{
+	VelocityFactors		factors;
+	AtmosphereContext	atmosphere;
+	BenchStage		stage;
+	double			sum = 0.0;
+
+	benchHeader("v2");
+
+	benchBegin(&stage, "setup", benchSetupIterations);
+	for (uint64_t i = 0; i < benchSetupIterations; i++)
+	{
+		precomputeEmbeddedVelocityFactors(&factors);
+		sum += factors.over;
+	}
+	benchEnd(&stage);
+
+	benchBegin(&stage, "setup-atmosphere", benchSetupIterations);
+	for (uint64_t i = 0; i < benchSetupIterations; i++)
+	{
+		loadUncertainAtmosphere(&atmosphere);
+		sum += atmosphere.r;
+	}
+	benchEnd(&stage);
+
+	benchBegin(&stage, "evaluate", iterations);
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		loadUncertainAtmosphere(&atmosphere);
+		sum += atmosphereLift(&atmosphere, &factors, defaultVelocity, defaultArea);
+	}
+	benchEnd(&stage);
+
+	benchBegin(&stage, "evaluate-context", iterations);
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		sum += atmosphereLift(&atmosphere, &factors, 10.0 + (i % 333), 0.1 + (i % 9) * 0.1);
+	}
+	benchEnd(&stage);
+
+	benchSink = sum;
+
+	return EXIT_SUCCESS;
+}
+
+/*
+ *	--spec: lift of every scenario of the specification, or with --batch the lift at every (V, A) of a
+ *	batch against the atmosphere of the selected (or only) scenario.
+ */
+static int
+runSpecification(const ModelOptions * options, const VelocityFactors * factors, FILE * input)
+{
+	UncertaintySpecification	specification;
+	const UncertaintyScenario *	selected = NULL;
+	int				status = EXIT_SUCCESS;
+
+	if (uncertaintySpecificationRead(options->specificationFile, &specification) != 0)
+	{
+		return EXIT_FAILURE;
+	}
+	if (options->scenario != NULL)
+	{
+		selected = uncertaintySpecificationFind(&specification, options->scenario);
+		if (selected == NULL)
+		{
+			fprintf(stderr, "%s has no scenario %s.\n", options->specificationFile, options->scenario);
+			uncertaintySpecificationFree(&specification);
+			return EXIT_FAILURE;
+		}
+	}
+	else if (specification.count == 1)
+	{
+		selected = &specification.scenarios[0];
+	}
+	if (options->batch && selected == NULL)
+	{
+		fprintf(stderr, "--batch needs --scenario when %s has several scenarios.\n", options->specificationFile);
+		status = EXIT_FAILURE;
+	}
+	else if (!LIFT_MONTE_CARLO && uncertaintySpecificationBuild(&specification) != 0)
+	{
+		fprintf(stderr, "Could not build the distributions of %s.\n", options->specificationFile);
+		status = EXIT_FAILURE;
+	}
+	if (status != EXIT_SUCCESS)
+	{
+		uncertaintySpecificationFree(&specification);
+		return status;
+	}
+
+	if (options->batch)
+	{
+#if LIFT_MONTE_CARLO
+		AtmosphereContext	atmosphere;
+
+		status = meanAtmosphere(options, selected, &atmosphere) == 0 ?
+				runBatchAtmosphere(input, &atmosphere, factors) : EXIT_FAILURE;
+#else
+		status = runBatchAtmosphere(input, &selected->atmosphere, factors);
+#endif
+	}
+	else
+	{
+		for (size_t s = 0; s < specification.count && status == EXIT_SUCCESS; s++)
+		{
+			const UncertaintyScenario *	scenario = &specification.scenarios[s];
+
+			if (selected != NULL && scenario != selected)
+			{
+				continue;
+			}
+#if LIFT_MONTE_CARLO
+			status = printMonteCarloLift(options, scenario, factors) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+			printLift(scenario->name, atmosphereLift(&scenario->atmosphere, factors, scenario->point.V,
+					scenario->point.A));
+#endif
+		}
+	}
+	uncertaintySpecificationFree(&specification);
+
+	return status;
+}
+#endif
+
+/*
+ *	v2: lift with uncertain elevation, temperature and humidity, at 30 m/s and 0.23 m^2 or at every
+ *	(V, A) of a batch; --spec replaces these built-in distributions. With the Monte Carlo backend, a
+ *	single lift is printed as its sample mean followed by a summary line, and a batch gives the mean
+ *	lift of each line.
+ */
+int
+runUncertainAtmosphere(const ModelOptions * options)
+{
+#if LIFT_HAVE_UNCERTAIN
+	VelocityFactors		factors;
+	AtmosphereContext	atmosphere;
+	FILE *			input = stdin;
+	int			status;
+
+	if (options->bench)
+	{
+		return runBench(options->benchIterations > 0 ? options->benchIterations : 1000);
+	}
+
+	precomputeEmbeddedVelocityFactors(&factors);
+
+	if (!options->batch && options->specificationFile == NULL)
+	{
+#if LIFT_MONTE_CARLO
+		return printMonteCarloLift(options, NULL, &factors) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+		loadUncertainAtmosphere(&atmosphere);
+		printLift("", atmosphereLift(&atmosphere, &factors, defaultVelocity, defaultArea));
+
+		return 0;
+#endif
+	}
+
+	if (options->batch && options->batchFile != NULL && strcmp(options->batchFile, "-") != 0)
+	{
+		input = fopen(options->batchFile, "r");
+		if (input == NULL)
+		{
+			fprintf(stderr, "Could not open %s.\n", options->batchFile);
+			return EXIT_FAILURE;
+		}
+	}
+	if (options->specificationFile != NULL)
+	{
+		status = runSpecification(options, &factors, input);
+	}
+	else
+	{
+#if LIFT_MONTE_CARLO
+		status = meanAtmosphere(options, NULL, &atmosphere) == 0 ?
+				runBatchAtmosphere(input, &atmosphere, &factors) : EXIT_FAILURE;
+#else
+		loadUncertainAtmosphere(&atmosphere);
+		status = runBatchAtmosphere(input, &atmosphere, &factors);
+#endif
+	}
+	if (input != stdin)
+	{
+		fclose(input);
+	}
+
+	return status;
+#else
+	(void) options;
+	fprintf(stderr, "v2 needs the uncertainty runtime (uncertain.h), which this build does not have.\n");
+
+	return EXIT_FAILURE;
+#endif
+}
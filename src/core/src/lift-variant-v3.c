@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "lift-core.h"
+
+enum
+{
+	benchParseIterations	= 100,
+	benchSetupIterations	= 1000,
+};
+
+/*
+ *	Stages of v3: parse (streaming the CSV into running sums, reading it whole when curves are
+ *	interpolated, or mapping a binary table; skipped for the table built into the model), setup (velocity
+ *	factors per angle of attack and their joint distribution), configure-context (the factors of the
+ *	expected lift in an evaluation context, which reuses its arena and allocates nothing) and evaluate
+ *	(density chain and lift).
+ */
+static int
+runBench(const char * filename, IntegrationMode mode, const AngleWeights * weights, uint64_t iterations)
+{
+	CpTable		table;
+	CpStatistics	statistics;
+	VelocityFactors	factors;
+	LiftContext	context;
+	BenchStage	stage;
+	double		sum = 0.0;
+	int		failed = 0;
+	int		embedded = filename == NULL;
+	int		binary = embedded || cpTableMap(filename, &table) == 0;
+	int		whole = binary || (weights != NULL && weights->interpolation != AngleInterpolationNone &&
+				cpTableReadCsv(filename, &table) == 0);
+
+	if (embedded)
+	{
+		cpTableEmbedded(&table);
+	}
+	else if (!whole && cpStatisticsReadCsv(filename, &statistics) != 0)
+	{
+		return EXIT_FAILURE;
+	}
+
+	benchHeader("v3");
+
+	if (!embedded)
+	{
+		benchBegin(&stage, binary ? "parse-map" : whole ? "parse-csv-table" : "parse-csv", benchParseIterations);
+		for (uint64_t i = 0; i < benchParseIterations && !failed; i++)
+		{
+			if (binary)
+			{
+				CpTable	mapped;
+
+				failed = cpTableMap(filename, &mapped) != 0;
+				if (!failed)
+				{
+					sum += mapped.values[0];
+					cpTableFree(&mapped);
+				}
+			}
+			else if (whole)
+			{
+				CpTable	read;
+
+				failed = cpTableReadCsv(filename, &read) != 0;
+				if (!failed)
+				{
+					sum += read.values[0];
+					cpTableFree(&read);
+				}
+			}
+			else
+			{
+				CpStatistics	streamed;
+
+				failed = cpStatisticsReadCsv(filename, &streamed) != 0;
+				if (!failed)
+				{
+					sum += streamed.columns[0].mean;
+					liftFree(streamed.columns);
+				}
+			}
+		}
+		benchEnd(&stage);
+	}
+	if (failed)
+	{
+		printf("Could not read %s.\n", filename);
+		if (whole)
+		{
+			cpTableFree(&table);
+		}
+		else
+		{
+			liftFree(statistics.columns);
+		}
+		return EXIT_FAILURE;
+	}
+
+	benchBegin(&stage, "setup", benchSetupIterations);
+	for (uint64_t i = 0; i < benchSetupIterations; i++)
+	{
+		if (whole)
+		{
+			precomputeVelocityFactors(&table, mode, weights, &factors);
+		}
+		else
+		{
+			precomputeVelocityFactorsFromStatistics(&statistics, mode, weights, &factors);
+		}
+		sum += factors.over;
+	}
+	benchEnd(&stage);
+	if (!embedded && whole)
+	{
+		cpTableFree(&table);
+	}
+	else if (!whole)
+	{
+		liftFree(statistics.columns);
+	}
+
+	if (liftContextInit(&context, filename) == 0)
+	{
+		benchBegin(&stage, "configure-context", benchSetupIterations);
+		for (uint64_t i = 0; i < benchSetupIterations; i++)
+		{
+			liftContextConfigure(&context, mode, weights);
+			sum += context.factors.over;
+		}
+		benchEnd(&stage);
+		liftContextFree(&context);
+	}
+
+	benchBegin(&stage, "evaluate", iterations);
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		sum += computeLift(&defaultOperatingPoint, &factors);
+	}
+	benchEnd(&stage);
+
+	benchSink = sum;
+
+	return EXIT_SUCCESS;
+}
+
+/*
+ *	--serve: load the table once, fully, into an evaluation context (a CSV is read into memory rather than
+ *	streamed, so that the weights and the integration mode can change between queries), and answer
+ *	queries on stdin.
+ */
+static int
+serve(const ModelOptions * options)
+{
+	LiftContext	context;
+	int		status;
+
+	if (liftContextInit(&context, options->tableFile) != 0)
+	{
+		printf("Could not load the Cp table %s.\n", options->tableFile);
+		exit(1);
+	}
+	if (liftContextConfigure(&context, options->integration, options->weights) != 0)
+	{
+		printf("error no angle of attack has a positive weight, or one is outside the table\n");
+		liftContextFree(&context);
+		return EXIT_FAILURE;
+	}
+
+	status = runService(&context, stdin, stdout);
+	liftContextFree(&context);
+
+	return status;
+}
+
+#if LIFT_MONTE_CARLO
+/*
+ *	Monte Carlo backend: every sample draws one angle of attack's velocity factors.
+ */
+static void
+evaluateLiftSamples(void * context, uint64_t first, size_t count, double * values)
+{
+	const FactorSamples *	samples = context;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		VelocityFactors	factors;
+
+		monteCarloSelectSample(first + i);
+		velocityFactorsFromSamples(samples, &factors);
+		values[i] = computeLift(&defaultOperatingPoint, &factors);
+	}
+}
+
+/*
+ *	Mean lift, then the summary line.
+ */
+static int
+printMonteCarloLift(const ModelOptions * options, const FactorSamples * samples)
+{
+	MonteCarloSummary	summary;
+	MonteCarloOptions	run = {
+		.samples	= options->samples > 0 ? options->samples : monteCarloDefaultSamples,
+		.seed		= options->seed,
+		.sampler	= options->sampler,
+		.threadCount	= options->threadCount,
+	};
+#if defined(LIFT_CUDA)
+	MonteCarloModel		model = {
+		.point			= defaultOperatingPoint,
+		.drawCount		= 1,
+		.draws			= {{.kind = MonteCarloDrawFactors}},
+		.factorSampleCount	= samples->count,
+		.factorSamples		= (const double (*)[2]) samples->samples,
+	};
+
+	run.gpu = options->gpu ? &model : NULL;
+#endif
+
+	if (monteCarloEstimate(&run, evaluateLiftSamples, (void *) samples, &summary) != 0)
+	{
+		printf("Could not run %llu Monte Carlo samples.\n", (unsigned long long) run.samples);
+		exit(1);
+	}
+	printf("Lift force = %f\n", summary.mean);
+	monteCarloPrintSummary(stdout, &summary);
+
+	return 0;
+}
+#endif
+
+/*
+ *	v3: lift at the default operating point with the uncertain angle of attack of a Cp table. With the
+ *	Monte Carlo backend, the lift is printed as its sample mean followed by a summary line.
+ */
+int
+runUncertainAngleOfAttack(const ModelOptions * options)
+{
+	CpTable		table;
+	CpStatistics	statistics;
+	FactorSamples	samples;
+	int		status;
+#if !LIFT_MONTE_CARLO
+	VelocityFactors	factors;
+#endif
+
+	/*
+	 *	The evaluation context computes the expected lift itself, so serving needs no uncertainty runtime.
+	 */
+	if (options->serve)
+	{
+		return serve(options);
+	}
+
+	if (!LIFT_HAVE_UNCERTAIN)
+	{
+		printf("v3 needs the uncertainty runtime (uncertain.h), which this build does not have.\n");
+		exit(1);
+	}
+	if (options->bench)
+	{
+		return runBench(options->tableFile, options->integration, options->weights,
+				options->benchIterations > 0 ? options->benchIterations : 1000000);
+	}
+
+	/*
+	 *	Binary tables are used in place; a CSV only needs its running sums, so it is streamed rather than
+	 *	loaded, unless curves are interpolated between its angles. Without an input file, the table built
+	 *	into the model is used.
+	 */
+	if (options->tableFile == NULL)
+	{
+		cpTableEmbedded(&table);
+		status = velocityFactorSamples(&table, options->integration, options->weights, &samples);
+	}
+	else if ((status = cpTableMap(options->tableFile, &table)) == 0 ||
+		(status == 1 && options->weights != NULL && options->weights->interpolation != AngleInterpolationNone &&
+			(status = cpTableReadCsv(options->tableFile, &table)) == 0))
+	{
+		status = velocityFactorSamples(&table, options->integration, options->weights, &samples);
+		cpTableFree(&table);
+	}
+	else if (status == 1 && cpStatisticsReadCsv(options->tableFile, &statistics) == 0)
+	{
+		status = velocityFactorSamplesFromStatistics(&statistics, options->integration, options->weights, &samples);
+		liftFree(statistics.columns);
+	}
+	if (status != 0)
+	{
+		printf("Could not load the Cp table %s (or no angle of attack has a positive weight, or one is outside the table).\n",
+			options->tableFile != NULL ? options->tableFile : "built into the model");
+		exit(1);
+	}
+
+#if LIFT_MONTE_CARLO
+	status = printMonteCarloLift(options, &samples);
+#else
+	velocityFactorsFromSamples(&samples, &factors);
+	printf("Lift force = %f\n", computeLift(&defaultOperatingPoint, &factors));
+#endif
+	factorSamplesFree(&samples);
+
+	return status;
+}
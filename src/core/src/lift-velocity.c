@@ -0,0 +1,569 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lift-core.h"
+
+/*
+ *	Simpson's rule over the two intervals x0 < x1 < x2 of possibly different widths.
+ */
+static double
+simpsonSegment(double x0, double f0, double x1, double f1, double x2, double f2)
+{
+	double	h0 = x1 - x0;
+	double	h1 = x2 - x1;
+
+	if (h0 <= 0.0 || h1 <= 0.0)
+	{
+		return 0.5 * h0 * (f0 + f1) + 0.5 * h1 * (f1 + f2);
+	}
+
+	return (h0 + h1) / 6.0 * ((2.0 - h1 / h0) * f0 + (h0 + h1) * (h0 + h1) / (h0 * h1) * f1 + (2.0 - h0 / h1) * f2);
+}
+
+/*
+ *	Add a station's sqrt(|1-Cp|), or anything else the factor is linear in, such as its derivative.
+ */
+static void
+velocityIntegralAddVelocity(VelocityIntegral * integral, double x, double velocity)
+{
+	if (integral->count == 0)
+	{
+		integral->firstX = x;
+	}
+	if (integral->count >= 1)
+	{
+		integral->trapezoidSum += 0.5 * (x - integral->x[0]) * (velocity + integral->velocity[0]);
+	}
+	if (integral->count >= 2 && integral->count % 2 == 0)
+	{
+		integral->simpsonSum += simpsonSegment(integral->x[1], integral->velocity[1],
+					integral->x[0], integral->velocity[0], x, velocity);
+	}
+	integral->velocitySum	+= velocity;
+	integral->x[1]		= integral->x[0];
+	integral->velocity[1]	= integral->velocity[0];
+	integral->x[0]		= x;
+	integral->velocity[0]	= velocity;
+	integral->count++;
+}
+
+void
+velocityIntegralAdd(VelocityIntegral * integral, double x, double Cp)
+{
+	velocityIntegralAddVelocity(integral, x, sqrt(fabs(1-Cp)));
+}
+
+/*
+ *	Average of sqrt(|1-Cp|) over the curve. The chord-weighted modes fall back to the mean for curves that
+ *	do not span a positive chord.
+ */
+double
+velocityIntegralFactor(const VelocityIntegral * integral, IntegrationMode mode)
+{
+	double	span	= integral->x[0] - integral->firstX;
+	double	simpson	= integral->simpsonSum;
+
+	if (mode == IntegrationMean || integral->count < 2 || !(span > 0.0))
+	{
+		return integral->velocitySum / integral->count;
+	}
+	if (mode == IntegrationTrapezoid)
+	{
+		return integral->trapezoidSum / span;
+	}
+	if (integral->count % 2 == 0)
+	{
+		simpson += 0.5 * (integral->x[0] - integral->x[1]) * (integral->velocity[0] + integral->velocity[1]);
+	}
+
+	return simpson / span;
+}
+
+/*
+ *	Average of sqrt(|1-Cp|) over one Cp curve. Since 𝑣x = V * sqrt(|1-Cpx|), the average velocity over a
+ *	surface is V times this factor. Uses the same running sums as a streamed CSV, so both give identical
+ *	factors.
+ */
+double
+velocityFactor(const CpTable * table, size_t angle, CpSurface surface, IntegrationMode mode)
+{
+	const double *		x	= cpTableColumn(table, 0);
+	const double *		Cp	= cpTableCurve(table, angle, surface);
+	VelocityIntegral	integral;
+
+	memset(&integral, 0, sizeof(integral));
+	for (size_t i = 0; i < table->rows; i++)
+	{
+		velocityIntegralAdd(&integral, x[i], Cp[i]);
+	}
+
+	return velocityIntegralFactor(&integral, mode);
+}
+
+/*
+ *	Add `weight`, and its derivative with respect to the angle, to the plan's weight of `curve`.
+ */
+static void
+addPlanWeight(CurvePlan * plan, size_t curve, double weight, double slope)
+{
+	for (size_t j = 0; j < plan->count; j++)
+	{
+		if (plan->curves[j] == curve)
+		{
+			plan->weights[j]	+= weight;
+			plan->slopes[j]		+= slope;
+			return;
+		}
+	}
+	plan->curves[plan->count]	= curve;
+	plan->weights[plan->count]	= weight;
+	plan->slopes[plan->count]	= slope;
+	plan->count++;
+}
+
+/*
+ *	Plan the curve at `angle`. Returns 0, or -1 if `angle` is outside the tabulated range (or, without an
+ *	interpolation, not tabulated).
+ */
+int
+curvePlanInit(CurvePlan * plan, const CpLayout * layout, double angle, AngleInterpolation interpolation)
+{
+	const double *	a = layout->angles;
+	size_t		n = layout->angleCount;
+	size_t		k = 0;
+	double		h, t;
+
+	plan->count = 0;
+	if (n == 0 || !(angle >= a[0] - 1e-9 && angle <= a[n - 1] + 1e-9))
+	{
+		return -1;
+	}
+	while (k + 2 < n && a[k + 1] <= angle)
+	{
+		k++;
+	}
+	if (interpolation == AngleInterpolationNone || n < 2)
+	{
+		for (size_t j = k; j < n && j <= k + 1; j++)
+		{
+			if (fabs(angle - a[j]) < 1e-9)
+			{
+				addPlanWeight(plan, j, 1.0, 0.0);
+				return 0;
+			}
+		}
+		return -1;
+	}
+
+	h = a[k + 1] - a[k];
+	t = (angle - a[k]) / h;
+	if (interpolation == AngleInterpolationLinear)
+	{
+		addPlanWeight(plan, k, 1.0 - t, -1.0 / h);
+		addPlanWeight(plan, k + 1, t, 1.0 / h);
+		return 0;
+	}
+
+	/*
+	 *	p(t) = h00 p[k] + h01 p[k+1] + h * (h10 m[k] + h11 m[k+1]), with m[k] = (p[k+1] - p[k-1]) /
+	 *	(a[k+1] - a[k-1]) inside the table and the one-sided difference at its ends; the slopes are the
+	 *	derivatives of the basis, d/dangle = d/dt / h. At a tabulated angle the weights are exactly 1 and
+	 *	0, so the curve is the tabulated one.
+	 */
+	{
+		double	h00 = (1.0 + 2.0 * t) * (1.0 - t) * (1.0 - t);
+		double	h01 = t * t * (3.0 - 2.0 * t);
+		double	h10 = t * (1.0 - t) * (1.0 - t) * h;
+		double	h11 = t * t * (t - 1.0) * h;
+		double	d00 = (6.0 * t * t - 6.0 * t) / h;
+		double	d01 = -d00;
+		double	d10 = 3.0 * t * t - 4.0 * t + 1.0;
+		double	d11 = 3.0 * t * t - 2.0 * t;
+		size_t	before = k > 0 ? k - 1 : k;
+		size_t	after = k + 2 < n ? k + 2 : k + 1;
+		double	spanBefore = a[k + 1] - a[before];
+		double	spanAfter = a[after] - a[k];
+
+		addPlanWeight(plan, k, h00, d00);
+		addPlanWeight(plan, k + 1, h01, d01);
+		addPlanWeight(plan, k + 1, h10 / spanBefore, d10 / spanBefore);
+		addPlanWeight(plan, before, -h10 / spanBefore, -d10 / spanBefore);
+		addPlanWeight(plan, after, h11 / spanAfter, d11 / spanAfter);
+		addPlanWeight(plan, k, -h11 / spanAfter, -d11 / spanAfter);
+	}
+
+	return 0;
+}
+
+/*
+ *	velocityFactor() of the planned curve, formed station by station from the contiguous curves.
+ */
+double
+plannedVelocityFactor(const CpTable * table, const CurvePlan * plan, CpSurface surface, IntegrationMode mode)
+{
+	const double *		x = cpTableColumn(table, 0);
+	const double *		curves[4];
+	VelocityIntegral	integral;
+
+	for (size_t j = 0; j < plan->count; j++)
+	{
+		curves[j] = cpTableCurve(table, plan->curves[j], surface);
+	}
+	memset(&integral, 0, sizeof(integral));
+	for (size_t i = 0; i < table->rows; i++)
+	{
+		double	Cp = 0.0;
+
+		for (size_t j = 0; j < plan->count; j++)
+		{
+			Cp += plan->weights[j] * curves[j][i];
+		}
+		velocityIntegralAdd(&integral, x[i], Cp);
+	}
+
+	return velocityIntegralFactor(&integral, mode);
+}
+
+/*
+ *	Derivative of plannedVelocityFactor() with respect to the angle (per degree): the factor is linear in
+ *	sqrt(|1-Cp|), whose derivative is -sign(1-Cp) dCp/dangle / (2 sqrt(|1-Cp|)), taken as 0 where Cp = 1.
+ */
+double
+plannedVelocityFactorSlope(const CpTable * table, const CurvePlan * plan, CpSurface surface, IntegrationMode mode)
+{
+	const double *		x = cpTableColumn(table, 0);
+	const double *		curves[4];
+	VelocityIntegral	integral;
+
+	for (size_t j = 0; j < plan->count; j++)
+	{
+		curves[j] = cpTableCurve(table, plan->curves[j], surface);
+	}
+	memset(&integral, 0, sizeof(integral));
+	for (size_t i = 0; i < table->rows; i++)
+	{
+		double	Cp = 0.0;
+		double	slope = 0.0;
+		double	velocity;
+
+		for (size_t j = 0; j < plan->count; j++)
+		{
+			Cp	+= plan->weights[j] * curves[j][i];
+			slope	+= plan->slopes[j] * curves[j][i];
+		}
+		velocity = sqrt(fabs(1-Cp));
+		velocityIntegralAddVelocity(&integral, x[i],
+			velocity > 0.0 ? (Cp < 1.0 ? -slope : slope) / (2.0 * velocity) : 0.0);
+	}
+
+	return velocityIntegralFactor(&integral, mode);
+}
+
+int
+parseAngleWeights(const char * specification, AngleWeights * weights)
+{
+	const char *	cursor = specification;
+
+	weights->count = 0;
+	while (*cursor != '\0')
+	{
+		char *	end;
+
+		if (weights->count == cpMaxAngles)
+		{
+			return -1;
+		}
+		weights->angles[weights->count] = strtod(cursor, &end);
+		if (end == cursor || *end != ':')
+		{
+			return -1;
+		}
+		cursor = end + 1;
+		weights->weights[weights->count] = strtod(cursor, &end);
+		if (end == cursor || weights->weights[weights->count] < 0.0 || (*end != ',' && *end != '\0'))
+		{
+			return -1;
+		}
+		weights->count++;
+		cursor = *end == ',' ? end + 1 : end;
+	}
+
+	return weights->count > 0 ? 0 : -1;
+}
+
+/*
+ *	Number of times each of `count` samples is repeated so that, out of about weightResolution samples,
+ *	they appear in proportion to their weights (largest-remainder rounding).
+ */
+static size_t
+weightedRepeats(const double * weight, size_t count, size_t * repeats)
+{
+	double	total = 0.0;
+	size_t	assigned = 0;
+
+	for (size_t k = 0; k < count; k++)
+	{
+		total += weight[k];
+	}
+	if (total <= 0.0)
+	{
+		return 0;
+	}
+
+	for (size_t k = 0; k < count; k++)
+	{
+		repeats[k] = (size_t) floor(weight[k] / total * weightResolution);
+		assigned += repeats[k];
+	}
+	while (assigned < weightResolution)
+	{
+		size_t	best = 0;
+		double	bestRemainder = -1.0;
+
+		for (size_t k = 0; k < count; k++)
+		{
+			double	remainder = weight[k] / total * weightResolution - repeats[k];
+
+			if (weight[k] > 0.0 && remainder > bestRemainder)
+			{
+				bestRemainder	= remainder;
+				best		= k;
+			}
+		}
+		repeats[best]++;
+		assigned++;
+	}
+
+	return assigned;
+}
+
+/*
+ *	Weights of the tabulated angles: the listed weight, or 0 for angles that are not listed.
+ */
+static void
+tabulatedWeights(const CpLayout * layout, const AngleWeights * weights, double * weight)
+{
+	for (size_t k = 0; k < layout->angleCount; k++)
+	{
+		weight[k] = 0.0;
+		for (size_t i = 0; i < weights->count; i++)
+		{
+			if (fabs(weights->angles[i] - layout->angles[k]) < 1e-9)
+			{
+				weight[k] = weights->weights[i];
+			}
+		}
+	}
+}
+
+/*
+ *	Every sample of the uncertain angle of attack is a whole Cp curve, so the mean of sqrt(|1-Cp|) over the
+ *	stations of the uncertain curve takes, sample for sample, the value computed from that curve alone.
+ *	The factors are therefore computed once per angle-of-attack curve and only the resulting (over, under)
+ *	pairs, one per angle, are turned into a joint distribution, instead of building a (stations*2)-
+ *	dimensional distribution of pressure coefficients and averaging it.
+ *	With weights, each pair is repeated in proportion to its weight, since every sample passed to
+ *	libUncertainDoubleDistFromMultidimensionalSamples() carries the same probability.
+ *	Takes ownership of `factorSamples`.
+ */
+static int
+buildFactorSamples(size_t sampleCount, double (*factorSamples)[2], const double * weight, FactorSamples * samples)
+{
+	samples->count		= sampleCount;
+	samples->samples	= factorSamples;
+	if (weight != NULL)
+	{
+		size_t	repeats[cpMaxAngles];
+		size_t	next = 0;
+
+		samples->count		= weightedRepeats(weight, sampleCount, repeats);
+		samples->samples	= samples->count == 0 ? NULL : liftMalloc(samples->count * sizeof(*samples->samples));
+		for (size_t k = 0; samples->samples != NULL && k < sampleCount; k++)
+		{
+			for (size_t i = 0; i < repeats[k]; i++, next++)
+			{
+				samples->samples[next][0] = factorSamples[k][0];
+				samples->samples[next][1] = factorSamples[k][1];
+			}
+		}
+		liftFree(factorSamples);
+	}
+
+	return samples->samples != NULL ? 0 : -1;
+}
+
+/*
+ *	Joint distribution of the factors over the (over, under) samples.
+ */
+int
+velocityFactorsFromSamples(const FactorSamples * samples, VelocityFactors * factors)
+{
+	double	uncertainFactors[2];
+
+#if LIFT_HAVE_UNCERTAIN
+	LIFT_TRACE_BEGIN(joint, TraceStageJoint);
+	libUncertainDoubleDistFromMultidimensionalSamples(
+			uncertainFactors,
+			(void *) samples->samples,
+			samples->count,
+			2);
+	LIFT_TRACE_END(joint);
+#else
+	(void) samples;
+	uncertainFactors[0] = uncertainFactors[1] = 0.0;
+#endif
+
+	factors->over	= uncertainFactors[0];
+	factors->under	= uncertainFactors[1];
+
+	return LIFT_HAVE_UNCERTAIN ? 0 : -1;
+}
+
+void
+factorSamplesFree(FactorSamples * samples)
+{
+	liftFree(samples->samples);
+	samples->samples	= NULL;
+	samples->count		= 0;
+}
+
+/*
+ *	Weighted angles with an interpolation: one sample per listed angle, from its planned curve.
+ */
+static int
+interpolatedFactorSamples(const CpTable * table, IntegrationMode mode, const AngleWeights * weights,
+		FactorSamples * samples)
+{
+	double	(*factorSamples)[2] = liftMalloc(weights->count * sizeof(*factorSamples));
+
+	if (factorSamples == NULL)
+	{
+		return -1;
+	}
+	LIFT_TRACE_BEGIN(velocity, TraceStageVelocity);
+	for (size_t i = 0; i < weights->count; i++)
+	{
+		CurvePlan	plan;
+
+		if (curvePlanInit(&plan, &table->layout, weights->angles[i], weights->interpolation) != 0)
+		{
+			liftFree(factorSamples);
+			return -1;
+		}
+		factorSamples[i][0] = plannedVelocityFactor(table, &plan, CpSurfaceOver, mode);
+		factorSamples[i][1] = plannedVelocityFactor(table, &plan, CpSurfaceUnder, mode);
+	}
+	LIFT_TRACE_END(velocity);
+	LIFT_TRACE_COUNT(TraceCounterAngles, weights->count);
+
+	return buildFactorSamples(weights->count, factorSamples, weights->weights, samples);
+}
+
+/*
+ *	Equally likely (over, under) samples of the uncertain angle of attack of `table`.
+ */
+int
+velocityFactorSamples(const CpTable * table, IntegrationMode mode, const AngleWeights * weights,
+		FactorSamples * samples)
+{
+	double	(*factorSamples)[2];
+	double	weight[cpMaxAngles];
+
+	if (weights != NULL && weights->interpolation != AngleInterpolationNone)
+	{
+		return interpolatedFactorSamples(table, mode, weights, samples);
+	}
+
+	factorSamples = liftMalloc(table->layout.angleCount * sizeof(*factorSamples));
+	if (factorSamples == NULL)
+	{
+		return -1;
+	}
+	LIFT_TRACE_BEGIN(velocity, TraceStageVelocity);
+	for (size_t k = 0; k < table->layout.angleCount; k++)
+	{
+		factorSamples[k][0] = velocityFactor(table, k, CpSurfaceOver, mode);
+		factorSamples[k][1] = velocityFactor(table, k, CpSurfaceUnder, mode);
+	}
+	LIFT_TRACE_END(velocity);
+	LIFT_TRACE_COUNT(TraceCounterAngles, table->layout.angleCount);
+	if (weights != NULL)
+	{
+		tabulatedWeights(&table->layout, weights, weight);
+	}
+
+	return buildFactorSamples(table->layout.angleCount, factorSamples, weights != NULL ? weight : NULL, samples);
+}
+
+/*
+ *	Same samples, from the running sums of a streamed CSV. Interpolated angles need the curves themselves,
+ *	which the running sums do not keep.
+ */
+int
+velocityFactorSamplesFromStatistics(const CpStatistics * statistics, IntegrationMode mode,
+		const AngleWeights * weights, FactorSamples * samples)
+{
+	double	(*factorSamples)[2];
+	double	weight[cpMaxAngles];
+
+	if (weights != NULL && weights->interpolation != AngleInterpolationNone)
+	{
+		return -1;
+	}
+
+	factorSamples = liftMalloc(statistics->layout.angleCount * sizeof(*factorSamples));
+	if (factorSamples == NULL)
+	{
+		return -1;
+	}
+	LIFT_TRACE_BEGIN(velocity, TraceStageVelocity);
+	for (size_t k = 0; k < statistics->layout.angleCount; k++)
+	{
+		const CpColumnStatistics *	over	= &statistics->columns[1 + 2 * k + CpSurfaceOver];
+		const CpColumnStatistics *	under	= &statistics->columns[1 + 2 * k + CpSurfaceUnder];
+
+		factorSamples[k][0] = velocityIntegralFactor(&over->integral, mode);
+		factorSamples[k][1] = velocityIntegralFactor(&under->integral, mode);
+	}
+	LIFT_TRACE_END(velocity);
+	LIFT_TRACE_COUNT(TraceCounterAngles, statistics->layout.angleCount);
+	if (weights != NULL)
+	{
+		tabulatedWeights(&statistics->layout, weights, weight);
+	}
+
+	return buildFactorSamples(statistics->layout.angleCount, factorSamples, weights != NULL ? weight : NULL,
+			samples);
+}
+
+int
+precomputeVelocityFactors(const CpTable * table, IntegrationMode mode, const AngleWeights * weights,
+		VelocityFactors * factors)
+{
+	FactorSamples	samples;
+	int		status = velocityFactorSamples(table, mode, weights, &samples);
+
+	if (status == 0)
+	{
+		status = velocityFactorsFromSamples(&samples, factors);
+		factorSamplesFree(&samples);
+	}
+
+	return status;
+}
+
+int
+precomputeVelocityFactorsFromStatistics(const CpStatistics * statistics, IntegrationMode mode,
+		const AngleWeights * weights, VelocityFactors * factors)
+{
+	FactorSamples	samples;
+	int		status = velocityFactorSamplesFromStatistics(statistics, mode, weights, &samples);
+
+	if (status == 0)
+	{
+		status = velocityFactorsFromSamples(&samples, factors);
+		factorSamplesFree(&samples);
+	}
+
+	return status;
+}
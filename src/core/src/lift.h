@@ -0,0 +1,103 @@
+/*
+ *	Embedding API of the lift model: the only header a host program needs, with the model behind an
+ *	opaque handle (lift-api.c).
+ *
+ *	A model is created from a Cp source (a binary Cp table or a CSV, or the table built into the model),
+ *	configured with an integration mode and optional angle-of-attack weights, and then evaluated at its
+ *	operating point, at any single point or over arrays of points. Results go to buffers the caller
+ *	provides; no call prints anything and, after liftModelCreate(), none allocates from the heap.
+ *
+ *	Threads: the evaluate calls only read the handle, so any number of threads may evaluate one model at
+ *	once. liftModelConfigure(), liftModelSetPoint() and liftModelDestroy() change it, and must not run
+ *	at the same time as any other call on the same model.
+ */
+#ifndef LIFT_H
+#define LIFT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct LiftModel	LiftModel;
+
+typedef enum
+{
+	LiftOk			= 0,
+	LiftErrorArgument	= -1,	/* NULL handle or buffer, or a malformed weight list */
+	LiftErrorTable		= -2,	/* the Cp source cannot be read */
+	LiftErrorWeights	= -3,	/* no angle of attack has a positive weight, or one is outside the table */
+	LiftErrorMemory		= -4,
+} LiftStatus;
+
+/*
+ *	How the velocity factor of a surface is formed from its stations, as with --integration.
+ */
+typedef enum
+{
+	LiftIntegrationMean,
+	LiftIntegrationTrapezoid,
+	LiftIntegrationSimpson,
+} LiftIntegration;
+
+/*
+ *	Cp curves at weighted angles between the tabulated ones, as with --interpolation.
+ */
+typedef enum
+{
+	LiftInterpolationNone,
+	LiftInterpolationLinear,
+	LiftInterpolationSpline,
+} LiftInterpolation;
+
+/*
+ *	Operating point: V in m/s, h in m, T in °C, Rh in [0, 1] and the wing area A in m².
+ */
+typedef struct
+{
+	double	V;
+	double	h;
+	double	T;
+	double	Rh;
+	double	A;
+} LiftPoint;
+
+/*
+ *	Create a model from `cpSource`, or from the table built into the model with NULL. It starts with the
+ *	mean over each surface, every angle of attack equally likely, and the default operating point.
+ */
+LiftStatus	liftModelCreate(const char * cpSource, LiftModel ** model);
+
+/*
+ *	Change the integration mode and the angle-of-attack weights, given as `angle:weight,...` (NULL: all
+ *	angles equally likely, and `interpolation` is ignored). On error the model keeps its configuration.
+ */
+LiftStatus	liftModelConfigure(LiftModel * model, LiftIntegration integration, const char * weights,
+			LiftInterpolation interpolation);
+
+LiftStatus	liftModelSetPoint(LiftModel * model, const LiftPoint * point);
+
+/*
+ *	Lift in N at the model's operating point, or at `point`: the expected lift over the weighted angles of
+ *	attack, which is the mean lift v3 reports for the same weights.
+ */
+LiftStatus	liftModelEvaluate(const LiftModel * model, double * lift);
+LiftStatus	liftModelEvaluatePoint(const LiftModel * model, const LiftPoint * point, double * lift);
+
+/*
+ *	Lift of `count` points given as one array per input. A NULL array holds that input at the model's
+ *	operating point, so a sweep over V alone passes only `V`.
+ */
+LiftStatus	liftModelEvaluateArray(const LiftModel * model, size_t count, const double * V, const double * h,
+			const double * T, const double * Rh, const double * A, double * lift);
+
+void		liftModelDestroy(LiftModel * model);
+
+const char *	liftStatusMessage(LiftStatus status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
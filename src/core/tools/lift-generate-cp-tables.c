@@ -0,0 +1,131 @@
+/*
+ *	Generates core/src/lift-cp-tables.h, the Cp table built into the model, from a CSV or binary Cp table:
+ *
+ *		lift-generate-cp-tables v3/inputs/all_angles.csv > core/src/lift-cp-tables.h
+ *
+ *	The header holds the table in store order (see CpTable) and the velocity factors of every angle of
+ *	attack for every integration mode, computed here with the model's own velocityFactor(), so the model
+ *	starts without parsing anything. Values are printed with the fewest significant digits that still
+ *	round-trip exactly. The generator only needs the table modules of the core, so it builds without the
+ *	header it generates:
+ *
+ *		cc -DLIFT_NO_MONTE_CARLO -o lift-generate-cp-tables core/tools/lift-generate-cp-tables.c \
+ *			core/src/lift-alloc.c core/src/lift-cp-table.c core/src/lift-csv.c core/src/lift-velocity.c -lm
+ *
+ *	LIFT_NO_MONTE_CARLO leaves out the joint distribution of lift-velocity.c, which needs the Monte Carlo
+ *	backend or the uncertainty runtime; the generator only uses the per-angle factors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/lift-core.h"
+
+static const char *	integrationNames[] = {
+	[IntegrationMean]	= "IntegrationMean",
+	[IntegrationTrapezoid]	= "IntegrationTrapezoid",
+	[IntegrationSimpson]	= "IntegrationSimpson",
+};
+
+/*
+ *	Shortest of %.15g, %.16g and %.17g that reads back as `value`.
+ */
+static const char *
+exact(double value)
+{
+	static char	text[4][32];
+	static int	next;
+	char *		out = text[next++ % 4];
+
+	for (int digits = 15; digits <= 17; digits++)
+	{
+		snprintf(out, sizeof(text[0]), "%.*g", digits, value);
+		if (strtod(out, NULL) == value)
+		{
+			break;
+		}
+	}
+
+	return out;
+}
+
+static void
+printTable(const char * source, const CpTable * table)
+{
+	printf("/*\n");
+	printf(" *\tGenerated by core/tools/lift-generate-cp-tables from %s; do not edit.\n", source);
+	printf(" *\tData of the Cp table built into the model, included by lift-cp-embedded.c only.\n");
+	printf(" */\n");
+	printf("enum {\n");
+	printf("\tembeddedCpRows\t\t= %zu,\n", table->rows);
+	printf("\tembeddedCpColumns\t= %zu,\n", table->columns);
+	printf("};\n\n");
+
+	printf("static const CpLayout\tembeddedCpLayout = {\n");
+	printf("\t.angleCount\t= %zu,\n", table->layout.angleCount);
+	printf("\t.angles\t\t= {");
+	for (size_t k = 0; k < table->layout.angleCount; k++)
+	{
+		printf("%s%s", k == 0 ? "" : ", ", exact(table->layout.angles[k]));
+	}
+	printf("},\n};\n\n");
+
+	printf("/*\n *\tColumn-major, in store order.\n */\n");
+	printf("static const double\tembeddedCpValues[embeddedCpColumns * embeddedCpRows] = {\n");
+	for (size_t j = 0; j < table->columns; j++)
+	{
+		char		name[cpTableNameLength];
+		const double *	column = cpTableColumn(table, j);
+
+		cpLayoutColumnName(&table->layout, j, name);
+		printf("\t/* %s */\n", name);
+		for (size_t i = 0; i < table->rows; i++)
+		{
+			printf("%s%s,%s", i % 8 == 0 ? "\t" : " ", exact(column[i]), i % 8 == 7 || i + 1 == table->rows ? "\n" : "");
+		}
+	}
+	printf("};\n\n");
+
+	printf("/*\n *\tVelocity factors per integration mode and angle of attack.\n */\n");
+	printf("static const VelocityFactors\tembeddedVelocityFactors[][%zu] = {\n", table->layout.angleCount);
+	for (size_t mode = IntegrationMean; mode <= IntegrationSimpson; mode++)
+	{
+		printf("\t[%s] = {\n", integrationNames[mode]);
+		for (size_t k = 0; k < table->layout.angleCount; k++)
+		{
+			printf("\t\t{.under = %s, .over = %s},\t/* %g° */\n",
+				exact(velocityFactor(table, k, CpSurfaceUnder, (IntegrationMode) mode)),
+				exact(velocityFactor(table, k, CpSurfaceOver, (IntegrationMode) mode)),
+				table->layout.angles[k]);
+		}
+		printf("\t},\n");
+	}
+	printf("};\n");
+}
+
+int main(int argc, char *	argv[])
+{
+	CpTable	table;
+	int	status;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "Usage: %s file.csv|file.cpt > lift-cp-tables.h\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	status = cpTableMap(argv[1], &table);
+	if (status == 1)
+	{
+		status = cpTableReadCsv(argv[1], &table);
+	}
+	if (status != 0)
+	{
+		fprintf(stderr, "Could not read %s.\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	printTable(argv[1], &table);
+	cpTableFree(&table);
+
+	return ferror(stdout) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
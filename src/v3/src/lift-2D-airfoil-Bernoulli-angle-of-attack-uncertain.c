@@ -1,11 +1,5 @@
 /*v3 - assume that angle of attack is uncertain (0°,5° or 10°) (pressure coefficient distributions will be selected accordingly) */
-#include <math.h>
-#include <stdint.h>
-#include <stdio.h>
-
-#include <string.h>
-#include <stdlib.h>
-#include <uncertain.h>
+#include "../../core/src/lift-core.h"
 
 /*  Overview: 
  *	Computation of generated lift force for a 2D NACA 2412 airfoil based on Bernoulli s equation (applicable only for inviscid and incompressible dry air flow)
@@ -18,7 +12,8 @@
  *  -   `T`:	    15 °C- ambient temperature uncertain 
  *  -   `Rh`:	    0.0 - humidity level (dry air)
  *	-	`V`:		30 m/s - free stream velocity below supersonic speed
- *	
+ *	-	angle of attack: one equally likely sample per `Curve<angle>`/`Curve<angle>l` column pair of the Cp table
+ *		(0°, 5° and 10° in all_angles.csv), or weighted with `--weights angle:weight,...`
  *
  *
  *  Velocities are being calculated based on pressure coefficient distributions 
@@ -42,153 +37,7 @@
  *
  */
 
-enum {
-     sampleCount     = 3,
-     row     = 140,
-	 col     = 7,
-     totalLength     = (row-1)*2,
-};
-
-void read_csv(int row, int col, char *filename, double **data){
-	FILE *file;
-	file = fopen(filename, "r");
-
-	int i = 0;
-    char line[4098];
-	while (fgets(line, 4098, file) && (i < row))
-    {
-        char* tmp = strdup(line);
-
-	    int j = 0;
-	    char* tok;
-	    for (tok = strtok(line, ";"); tok && *tok; j++, tok = strtok(NULL, ";\n"))
-	    {
-            int index=0;
-            while(tok[index]!='\0')
-            {
-                if(tok[index]==',')
-                {
-                    tok[index]='.';
-                }
-                index++;
-            }
-	        data[i][j] = atof(tok);
-	    }
-
-        free(tmp);
-        i++;
-    }
-}
-
-static void
-loadInputs(double *  A, double *  v1, double * v2, double * r,  double **data)
+int main(int argc, char *	argv[])
 {
-    double V  = 30.0;
-    double Rh = 0.0; 
-    double h  = 0.0; 
-    double T  = 15.0;
-    //air pressure
-    double Pair = exp((-9.81 * 0.0289644 * h)/(8.31432 * (T+273.15))) * 101325.0; // atm * sea level pressure 101325 hPa
-    //saturation vapor pressure
-    double Psat = 6.1078*pow(10.0,7.5*T/(T+237.3));
-    //water vapor pressure
-    double Pv = Psat*Rh;
-    //pressure of dry air
-    double Pd = Pair - Pv;
-
-    double empricalPressureOver10AOA[row-1];
-    double empricalPressureOver5AOA[row-1];
-    double empricalPressureOver0AOA[row-1];
-    double empricalPressureUnder0AOA[row-1];
-    double empricalPressureUnder5AOA[row-1];
-    double empricalPressureUnder10AOA[row-1];
-    for(int i = 1; i < row; i++)
-    {
-        empricalPressureOver10AOA[i-1] = data[i][1];
-        empricalPressureOver5AOA[i-1] = data[i][2];
-        empricalPressureOver0AOA[i-1] = data[i][3];
-        empricalPressureUnder0AOA[i-1] = data[i][4];
-        empricalPressureUnder5AOA[i-1] = data[i][5];
-        empricalPressureUnder10AOA[i-1] = data[i][6];
-    }
-    double empricalPressure10AOA[totalLength];
-    double empricalPressure5AOA[totalLength];
-    double empricalPressure0AOA[totalLength];
-
-    //create arrays that have over (from index 0 to row-1) and lower (from index row -1 to end of the array ) pressure coefficients for certain angles of attack
-    for (int i = 0; i < totalLength/2; i++)
-    {
-        empricalPressure10AOA[i]  =empricalPressureOver10AOA[i];
-        empricalPressure10AOA[i+row-1]=empricalPressureUnder10AOA[i];
-
-        empricalPressure5AOA[i]  =empricalPressureOver5AOA[i];
-        empricalPressure5AOA[i+row-1]=empricalPressureUnder5AOA[i];
-
-        empricalPressure0AOA[i]  =empricalPressureOver0AOA[i];
-        empricalPressure0AOA[i+row-1]=empricalPressureUnder0AOA[i];
-    }
-
-    double empiricalPressureCoefficientsUncertain[sampleCount][totalLength];
-  
-    for(int i = 0; i < totalLength; i++){
-            empiricalPressureCoefficientsUncertain[0][i] = empricalPressure10AOA[i];
-            empiricalPressureCoefficientsUncertain[1][i] = empricalPressure5AOA[i];
-            empiricalPressureCoefficientsUncertain[2][i] = empricalPressure0AOA[i];
-    }
-
-    double empiricalPressureCoefficients[totalLength];
-
-	libUncertainDoubleDistFromMultidimensionalSamples(
-			empiricalPressureCoefficients,
-			(void *) empiricalPressureCoefficientsUncertain,
-			sampleCount,
-			totalLength);
-
-    /*Vx = V * sqrt(|1-Cpx|) */ 
-	for (int i = 0; i < sizeof(empiricalPressureCoefficients)/sizeof(double)/2; i++) //(row-1) * sizeof(double)
-	{ 
-		*v2 += V * sqrt(fabs(1-empiricalPressureCoefficients[i]));
-        *v1 += V * sqrt(fabs(1-empiricalPressureCoefficients[row-1+i]));
-	}
-    
-	*v2 /= sizeof(empiricalPressureCoefficients)/sizeof(double)/2.0;
-    *v1 /= sizeof(empiricalPressureCoefficients)/sizeof(double)/2.0;
-	*A	= 2.3E-1;
-
-    /*  air density kg/m^3
-    r = (Pd/(Rd*T))+(Pv/(Rv*T)). */
-    *r = (Pd/(287.058*(T+273.15)))+(Pv/(461.495*(T+273.15)));
-
+	return liftMain(argc, argv, ModelVariantUncertainAngleOfAttack);
 }
-
-int main(int argc, char * argv[])
-{
-	if (argc < 1){
-		printf("Please specify the CSV file as an input.\n");
-		exit(0);
-	}
-
-    char fname[256]; strcpy(fname, argv[1]);
-
-    double ** data;
-	data = (double **)malloc(row * sizeof(double *));
-	for (int i = 0; i < row; ++i){
-		data[i] = (double *)malloc(col * sizeof(double));
-	}
-
-	double	A, v1, v2, r, liftForce;
-
-
-	read_csv(row, col, fname, data);
-	loadInputs(&A, &v1, &v2, &r, data);
-
-    /*	Fl = 1/2 * 𝜌 * a  * ((𝑣2)^2- (𝑣1)^2) */
-	liftForce = r*A*(pow(v2, 2)-pow(v1, 2)) / 2.0;
-
-	printf("Lift force = %f\n", liftForce);
-
-	return 0;
-}
-
-
-